@@ -4,17 +4,21 @@
 #include <vector>
 #include <cassert>
 #include <array>
+#include <cstdint>
+#include "../../misc/binary_io.hpp"
 
 //rank O(1), select O(lgN), memory 2Nbit
 struct bitvector_memory{
   static constexpr int s = 32;
   int n;
-  std::vector<int> RS{0}, table;
+  std::vector<int> RS{0};
+  std::vector<uint32_t> table;
   bitvector_memory(): n(0){}
   bitvector_memory(const std::vector<bool> &S): n(S.size()){
-    int pop = 0, m = 0;
+    int pop = 0;
+    uint32_t m = 0;
     for(int i = 0, t = 0; i < n; i++, t++){
-      if(S[i]) pop++, m += 1 << t;
+      if(S[i]) pop++, m += 1u << t;
       if(t == s - 1 || i == (n - 1)){
         RS.push_back(pop);
         table.push_back(m);
@@ -76,22 +80,111 @@ struct bitvector_memory{
     int r = rank0(k);
     return r == 0 ? -1 : select0(r - 1);
   }
+  void save(std::ostream &os)const{
+    write_binary(os, n);
+    write_binary(os, RS);
+    write_binary(os, table);
+  }
+  void load(std::istream &is){
+    read_binary(is, n);
+    read_binary(is, RS);
+    read_binary(is, table);
+  }
+};
+// rank O(1), select O(log(1の間隔)), memory 約1.8Nbit
+// 4096bitごとの累積(int) + 64bitごとの累積(uint16_t), selectは1の64個ごとの位置から単語単位で二分探索
+struct bitvector_succinct{
+  int n;
+  std::vector<uint64_t> words;
+  std::vector<int> super_rank;
+  std::vector<uint16_t> word_rank;
+  std::vector<int> sample1;
+  bitvector_succinct(): n(0){}
+  bitvector_succinct(const std::vector<bool> &v): n(v.size()){
+    std::vector<uint64_t> w((n >> 6) + 1, 0);
+    for(int i = 0; i < n; i++) if(v[i]) w[i >> 6] |= 1ULL << (i & 63);
+    build(std::move(w));
+  }
+  // ビット列をwords(下位bitから)で受け取る
+  bitvector_succinct(std::vector<uint64_t> w, int n): n(n){
+    w.resize((n >> 6) + 1, 0);
+    if(n & 63) w[n >> 6] &= (1ULL << (n & 63)) - 1;
+    else w[n >> 6] = 0;
+    build(std::move(w));
+  }
+  void build(std::vector<uint64_t> &&w){
+    words = std::move(w);
+    int m = words.size();
+    super_rank.resize((m >> 6) + 1);
+    word_rank.resize(m);
+    int pop = 0;
+    for(int i = 0; i < m; i++){
+      if((i & 63) == 0) super_rank[i >> 6] = pop;
+      word_rank[i] = pop - super_rank[i >> 6];
+      uint64_t x = words[i];
+      for(int c = pop, k = __builtin_popcountll(x); k > 0; x &= x - 1, c++, k--){
+        if((c & 63) == 0) sample1.push_back((i << 6) + __builtin_ctzll(x));
+      }
+      pop += __builtin_popcountll(words[i]);
+    }
+    if((m & 63) == 0) super_rank.back() = pop;
+  }
+  int size()const{
+    return n;
+  }
+  bool access(int k)const{
+    return (words[k >> 6] >> (k & 63)) & 1;
+  }
+  // [0, k)の1の数
+  int rank1(int k)const{
+    return super_rank[k >> 12] + word_rank[k >> 6] + __builtin_popcountll(words[k >> 6] & ((1ULL << (k & 63)) - 1));
+  }
+  int rank0(int k)const{
+    return k - rank1(k);
+  }
+  // words[0, w)の1の数
+  int rank_word(int w)const{
+    return super_rank[w >> 6] + word_rank[w];
+  }
+  // k番目(0-indexed)の1, 無い場合はn
+  int select1(int k)const{
+    if(k < 0 || (k >> 6) >= (int)sample1.size()) return n;
+    int lw = sample1[k >> 6] >> 6, rw = (k >> 6) + 1 < (int)sample1.size() ? (sample1[(k >> 6) + 1] >> 6) + 1 : words.size();
+    // rank_word(w) <= kとなる最大のw
+    while(rw - lw > 1){
+      int mid = (lw + rw) >> 1;
+      if(rank_word(mid) <= k) lw = mid;
+      else rw = mid;
+    }
+    k -= rank_word(lw);
+    uint64_t x = words[lw];
+    if(__builtin_popcountll(x) <= k) return n;
+    int pos = 0;
+    for(int b = 32; b >= 8; b >>= 1){
+      int c = __builtin_popcountll(x & ((1ULL << b) - 1));
+      if(c <= k) k -= c, x >>= b, pos += b;
+    }
+    while(k--) x &= x - 1;
+    return (lw << 6) + pos + __builtin_ctzll(x);
+  }
 };
 // rank O(1), select O(1), memory (2 + 32)Nbit
 struct bitvector_fast_select{
   static constexpr int s = 32;
   int n;
   std::vector<int> pos1, pos0;
-  std::vector<int> RS{0}, table;
+  std::vector<int> RS{0};
+  std::vector<uint32_t> table;
   bitvector_fast_select(){}
   bitvector_fast_select(const std::vector<bool> &v): n(v.size()){
     for(int i = 0; i < n; i++){
       if(v[i]) pos1.push_back(i);
       else pos0.push_back(i);
     }
-    int pop = 0, m = 0;
+    int pop = 0;
+    uint32_t m = 0;
     for(int i = 0, t = 0; i < n; i++, t++){
-      if(v[i]) pop++, m += 1 << t;
+      if(v[i]) pop++, m += 1u << t;
       if(t == s - 1 || i == (n - 1)){
         RS.push_back(pop);
         table.push_back(m);
@@ -116,11 +209,11 @@ struct bitvector_fast_select{
     return k - rank1(k);
   }
   int select1(int k){
-    if(k >= pos1.size()) return n;
+    if(k >= (int)pos1.size()) return n;
     return pos1[k];
   }
   int select0(int k){
-    if(k >= pos0.size()) return n;
+    if(k >= (int)pos0.size()) return n;
     return pos0[k];
   }
   // leftmost1, k < i
@@ -150,7 +243,8 @@ private:
   constexpr static int s = 16, th_l = 255, th_m = 64, s2 = 32;
   int n;
   // rank
-  std::vector<int> RS{0}, table;
+  std::vector<int> RS{0};
+  std::vector<uint32_t> table;
 
   // select
   struct block{
@@ -226,9 +320,10 @@ public:
   bitvector(){}
   bitvector(const std::vector<bool> &v): n(v.size()){
     // rank
-    int pop = 0, m = 0;
+    int pop = 0;
+    uint32_t m = 0;
     for(int i = 0, t = 0; i < n; i++, t++){
-      if(v[i]) pop++, m += 1 << t;
+      if(v[i]) pop++, m += 1u << t;
       if(t == s2 - 1 || i == (n - 1)){
         RS.push_back(pop);
         table.push_back(m);
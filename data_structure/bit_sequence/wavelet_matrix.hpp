@@ -186,16 +186,54 @@ private:
 public:
   wavelet_matrix(): n(0){}
   // 値が[0, inf)
-  wavelet_matrix(const std::vector<int> &v, int inf): n(v.size()), inf(inf), bottom_idx(n){
+  // use_index = falseの場合bottom_idx(Nワード)を捨てる, select, kth系の関数は使えない
+  wavelet_matrix(const std::vector<int> &v, int inf, bool use_index = true): n(v.size()), inf(inf), bottom_idx(n){
     assert(inf >= 0);
     h = 0;
     while((1 << h) < inf) h++;
     build(v);
+    if(!use_index) std::vector<int>().swap(bottom_idx);
+  }
+  int size()const{
+    return n;
   }
   // v[k]
   int access(int k){
     return __access(k);
   }
+  // {v[k], [0, k)のv[k]の数}
+  // 最下段でv[k]の区間に着いた時の位置がrankになる
+  std::pair<int, int> access_rank(int k){
+    assert(0 <= k && k < n);
+    int L = 0, R = n, ret = 0;
+    for(int i = h - 1; i >= 0; i--){
+      int L0 = bv[i].rank0(L), R0 = bv[i].rank0(R), k0 = bv[i].rank0(k);
+      if(bv[i].access(k)){
+        k += R0 - k0;
+        L += R0 - L0;
+        ret += 1 << i;
+      }else{
+        k -= (k - L) - (k0 - L0);
+        R = L + R0 - L0;
+      }
+    }
+    return {ret, k - L};
+  }
+  void save(std::ostream &os)const{
+    write_binary(os, n);
+    write_binary(os, h);
+    write_binary(os, inf);
+    for(int i = 0; i < h; i++) bv[i].save(os);
+    write_binary(os, bottom_idx);
+  }
+  void load(std::istream &is){
+    read_binary(is, n);
+    read_binary(is, h);
+    read_binary(is, inf);
+    bv.resize(h);
+    for(int i = 0; i < h; i++) bv[i].load(is);
+    read_binary(is, bottom_idx);
+  }
   // [0, r)のcの数
   int rank(int r, int c){
     return __rank(r, c);
@@ -1,6 +1,8 @@
 #ifndef _PARTIAL_RETROACTIVE_PRIORITY_QUEUE_H_
 #define _PARTIAL_RETROACTIVE_PRIORITY_QUEUE_H_
 #include <vector>
+#include <queue>
+#include <numeric>
 #include <algorithm>
 #include <limits>
 #include <cassert>
@@ -24,6 +26,8 @@ private:
     int balanace_factor(){return (l ? l->h : 0) - (r ? r->h : 0);}
   };
   node *dummy_max, *dummy_min, *tmp_node, *root;
+  // まとめた操作の数 * rebuild_ratio >= 列の長さなら作り直す
+  static constexpr int rebuild_ratio = 8;
 
   // pop用
   node *make_node(){
@@ -222,6 +226,66 @@ private:
       return (lmin->key < rmin->key ? lmin : rmin);
     }
   }
+  // 操作の列(中順)
+  std::vector<node*> collect(){
+    std::vector<node*> res, st;
+    res.reserve(len_sequence());
+    node *v = root;
+    while(v || !st.empty()){
+      while(v){
+        st.push_back(v);
+        v = v->l;
+      }
+      v = st.back();
+      st.pop_back();
+      res.push_back(v);
+      v = v->r;
+    }
+    return res;
+  }
+  node *build(const std::vector<node*> &seq, int l, int r){
+    if(l >= r) return nullptr;
+    int m = (l + r) >> 1;
+    node *v = seq[m];
+    if((v->l = build(seq, l, m))) v->l->p = v;
+    if((v->r = build(seq, m + 1, r))) v->r->p = v;
+    update(v);
+    return v;
+  }
+  // 操作の列を先頭から二分ヒープでシミュレーションして各insertのmodeを決め直し, 平衡な木を作り直す O(N log N)
+  void rebuild(const std::vector<node*> &seq){
+    std::priority_queue<std::pair<Key, int>, std::vector<std::pair<Key, int>>, std::greater<std::pair<Key, int>>> pq;
+    for(int i = 0; i < (int)seq.size(); i++){
+      node *v = seq[i];
+      if(v->mode == 2){
+        assert(!pq.empty()); // 空の状態でpopしてはいけない
+        seq[pq.top().second]->mode = 0;
+        pq.pop();
+      }else{
+        v->mode = 1;
+        pq.push({v->key, i});
+      }
+    }
+    if((root = build(seq, 0, seq.size()))) root->p = nullptr;
+  }
+  // k個の操作をまとめて行う時, 1個ずつ行うより作り直す方が速いか
+  bool use_rebuild(int k){
+    return (long long)k * rebuild_ratio >= len_sequence();
+  }
+  // pos[i]の位置にop[i]を挿入(同じ位置なら添字の順), posは操作前の列での位置
+  void insert_batch_inner(const std::vector<int> &pos, const std::vector<node*> &op){
+    int k = pos.size(), n = len_sequence();
+    std::vector<int> ord(k);
+    std::iota(ord.begin(), ord.end(), 0);
+    std::stable_sort(ord.begin(), ord.end(), [&](int a, int b){ return pos[a] < pos[b]; });
+    std::vector<node*> seq = collect(), res;
+    res.reserve(n + k);
+    for(int i = 0, j = 0; i <= n; i++){
+      for(; j < k && pos[ord[j]] == i; j++) res.push_back(op[ord[j]]);
+      if(i < n) res.push_back(seq[i]);
+    }
+    rebuild(res);
+  }
 public:
   partial_retroactive_priority_queue(): root(nullptr){
     dummy_max = make_node(minf);
@@ -292,6 +356,71 @@ public:
       }
     }
   }
+  // 操作前の列でのpos[i]の位置にkeys[i]のinsertを挿入する(同じ位置なら添字の順)
+  // 個数が列の長さに比べて多い場合は列を作り直す O(N log N), そうでなければ1個ずつ O(k log N)
+  void insert_batch(const std::vector<int> &pos, const std::vector<Key> &keys){
+    assert(pos.size() == keys.size());
+    int k = pos.size(), n = len_sequence();
+    for(int p : pos) assert(0 <= p && p <= n);
+    if(!use_rebuild(k)){
+      std::vector<int> ord(k);
+      std::iota(ord.begin(), ord.end(), 0);
+      std::stable_sort(ord.begin(), ord.end(), [&](int a, int b){ return pos[a] < pos[b]; });
+      for(int i = k - 1; i >= 0; i--) insert_op_insert(pos[ord[i]], keys[ord[i]]);
+      return;
+    }
+    std::vector<node*> op(k);
+    for(int i = 0; i < k; i++) op[i] = make_node(keys[i]);
+    insert_batch_inner(pos, op);
+  }
+  // 操作前の列でのpos[i]の位置にpopminを挿入する(同じ位置なら添字の順)
+  void insert_popmin_batch(const std::vector<int> &pos){
+    int k = pos.size(), n = len_sequence();
+    for(int p : pos) assert(0 <= p && p <= n);
+    if(!use_rebuild(k)){
+      std::vector<int> p2 = pos;
+      std::sort(p2.begin(), p2.end());
+      for(int i = k - 1; i >= 0; i--) insert_op_popmin(p2[i]);
+      return;
+    }
+    std::vector<node*> op(k);
+    for(int i = 0; i < k; i++) op[i] = make_node();
+    insert_batch_inner(pos, op);
+  }
+  // 操作前の列でのpos[i]番目の操作を削除する, posは重複しない
+  void erase_batch(std::vector<int> pos){
+    int k = pos.size(), n = len_sequence();
+    std::sort(pos.begin(), pos.end());
+    assert(std::unique(pos.begin(), pos.end()) == pos.end());
+    for(int p : pos) assert(0 <= p && p < n);
+    if(!use_rebuild(k)){
+      for(int i = k - 1; i >= 0; i--) erase_op(pos[i]);
+      return;
+    }
+    std::vector<node*> seq = collect(), res;
+    res.reserve(n - k);
+    for(int i = 0, j = 0; i < n; i++){
+      if(j < k && pos[j] == i) delete seq[i], j++;
+      else res.push_back(seq[i]);
+    }
+    rebuild(res);
+  }
+  // 現在の要素を昇順に, O(要素数 log N)
+  std::vector<Key> current(){
+    std::vector<Key> res;
+    res.reserve(root ? root->cnt_current : 0);
+    std::vector<node*> st;
+    if(root && root->cnt_current) st.push_back(root);
+    while(!st.empty()){
+      node *v = st.back();
+      st.pop_back();
+      if(v->mode == 1) res.push_back(v->key);
+      if(v->l && v->l->cnt_current) st.push_back(v->l);
+      if(v->r && v->r->cnt_current) st.push_back(v->r);
+    }
+    std::sort(res.begin(), res.end());
+    return res;
+  }
   // 現在のmin 空の場合はinf
   Key min(){
     return root ? root->min_current->key : inf;
@@ -94,4 +94,175 @@ public:
     return p->get(id, idx);
   }
 };
+
+template<typename Val, int B>
+struct persistent_array_chunked_iter;
+template<typename Val, int B>
+struct persistent_array_chunked_transient;
+
+// 長さ固定(n)の永続配列, 葉にB個の値を連続して持ち, 葉の番号を8分木で引く
+// 葉以外のノードは 子8個 + 4byte, setは高さ(log8(n / B))個のノードと葉1個をコピーする
+// transient(): 変更用のハンドルを作る, その中で作ったノードはfreeze()まで直接書き換える(同じ葉へのsetは2回目以降コピー無し)
+// ノードの持ち主(owner)が今のtransientの番号と一致する場合だけ書き換える, 0は永続(常にコピー)
+template<typename Val, int B = 32>
+struct persistent_array_chunked{
+  static constexpr int Split = 8, Mask = Split - 1, Shift = 3;
+  static_assert(B > 0);
+private:
+  struct inner{
+    std::array<int, Split> ch; // -1なら全てz
+    int owner;
+  };
+  struct leaf{
+    std::array<Val, B> val;
+    int owner;
+  };
+  int n, h; // 葉の上の段数, h = 0なら根が葉
+  Val z;
+  int edit_cnt;
+  std::vector<inner> in;
+  std::vector<leaf> lf;
+  int own_inner(int v, int e){
+    if(v != -1 && e && in[v].owner == e) return v;
+    inner x;
+    if(v == -1) x.ch.fill(-1);
+    else x = in[v];
+    x.owner = e;
+    in.push_back(x);
+    return (int)in.size() - 1;
+  }
+  int own_leaf(int v, int e){
+    if(v != -1 && e && lf[v].owner == e) return v;
+    leaf x;
+    if(v == -1) x.val.fill(z);
+    else x = lf[v];
+    x.owner = e;
+    lf.push_back(x);
+    return (int)lf.size() - 1;
+  }
+  // 根rootのk番目をxにした根, eは書き換えてよいノードの持ち主
+  int set(int root, int k, Val x, int e){
+    int id = k / B;
+    if(h == 0){
+      int u = own_leaf(root, e);
+      lf[u].val[k % B] = x;
+      return u;
+    }
+    int r = own_inner(root, e), v = r;
+    for(int d = h - 1; d > 0; d--){
+      int c = (id >> (Shift * d)) & Mask;
+      int u = own_inner(in[v].ch[c], e);
+      in[v].ch[c] = u;
+      v = u;
+    }
+    int u = own_leaf(in[v].ch[id & Mask], e);
+    in[v].ch[id & Mask] = u;
+    lf[u].val[k % B] = x;
+    return r;
+  }
+  Val get(int root, int k)const{
+    int id = k / B, v = root;
+    for(int d = h - 1; d >= 0 && v != -1; d--) v = in[v].ch[(id >> (Shift * d)) & Mask];
+    return v == -1 ? z : lf[v].val[k % B];
+  }
+  // 葉lから始まる高さdの部分木
+  int build(const std::vector<Val> &v, int l, int d){
+    int L = (n + B - 1) / B;
+    if(l >= L) return -1;
+    if(d == 0){
+      leaf x;
+      x.val.fill(z);
+      for(int i = 0; i < B && l * B + i < n; i++) x.val[i] = v[l * B + i];
+      x.owner = 0;
+      lf.push_back(x);
+      return (int)lf.size() - 1;
+    }
+    inner x;
+    for(int c = 0; c < Split; c++) x.ch[c] = build(v, l + c * (1 << (Shift * (d - 1))), d - 1);
+    x.owner = 0;
+    in.push_back(x);
+    return (int)in.size() - 1;
+  }
+  persistent_array_chunked(int n, Val z): n(n), h(0), z(z), edit_cnt(0){
+    assert(n >= 0);
+    int L = (n + B - 1) / B;
+    while(h < 10 && (1LL << (Shift * h)) < L) h++;
+  }
+  friend persistent_array_chunked_iter<Val, B>;
+  friend persistent_array_chunked_transient<Val, B>;
+};
+
+template<typename Val, int B = 32>
+struct persistent_array_chunked_iter{
+private:
+  using iter = persistent_array_chunked_iter<Val, B>;
+  using body = persistent_array_chunked<Val, B>;
+  int root;
+  body *p;
+  persistent_array_chunked_iter(int root, body *p): root(root), p(p){}
+public:
+  persistent_array_chunked_iter(): root(-1), p(nullptr){}
+  // 長さn, 全てz
+  persistent_array_chunked_iter(int n, Val z): root(-1){
+    p = new body(n, z);
+  }
+  persistent_array_chunked_iter(const std::vector<Val> &v, Val z = Val()): iter(v.size(), z){
+    root = p->build(v, 0, p->h);
+  }
+  int size()const{
+    return p->n;
+  }
+  iter set(int k, Val x)const{
+    assert(0 <= k && k < p->n);
+    return iter(p->set(root, k, x, 0), p);
+  }
+  Val get(int k)const{
+    assert(0 <= k && k < p->n);
+    return p->get(root, k);
+  }
+  // このバージョンから始まる変更用のハンドル(このバージョンは変わらない)
+  persistent_array_chunked_transient<Val, B> transient()const{
+    return persistent_array_chunked_transient<Val, B>(root, p);
+  }
+  friend persistent_array_chunked_transient<Val, B>;
+};
+
+// persistent_array_chunked_iterへのまとめた書き込み, freeze()の後は使えない
+// コピーするとfreeze()した後も同じ番号で書き換えられてしまうのでムーブのみ(ムーブ元は無効になる)
+template<typename Val, int B = 32>
+struct persistent_array_chunked_transient{
+private:
+  using body = persistent_array_chunked<Val, B>;
+  int root, e;
+  body *p;
+  persistent_array_chunked_transient(int root, body *p): root(root), e(++p->edit_cnt), p(p){}
+public:
+  persistent_array_chunked_transient(const persistent_array_chunked_transient&) = delete;
+  persistent_array_chunked_transient &operator=(const persistent_array_chunked_transient&) = delete;
+  persistent_array_chunked_transient(persistent_array_chunked_transient &&x): root(x.root), e(x.e), p(x.p){
+    x.e = 0;
+  }
+  persistent_array_chunked_transient &operator=(persistent_array_chunked_transient &&x){
+    if(this != &x) root = x.root, e = x.e, p = x.p, x.e = 0;
+    return *this;
+  }
+  int size()const{
+    return p->n;
+  }
+  void set(int k, Val x){
+    assert(e && 0 <= k && k < p->n);
+    root = p->set(root, k, x, e);
+  }
+  Val get(int k)const{
+    assert(e && 0 <= k && k < p->n);
+    return p->get(root, k);
+  }
+  // 今の内容のバージョンを返し, このハンドルを無効にする
+  persistent_array_chunked_iter<Val, B> freeze(){
+    assert(e);
+    e = 0;
+    return persistent_array_chunked_iter<Val, B>(root, p);
+  }
+  friend persistent_array_chunked_iter<Val, B>;
+};
 #endif
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <cassert>
 #include <iostream>
 #include "../../algebraic_structure/monoid.hpp"
+#include "persistent_node_arena.hpp"
 
 template<typename monoid>
 struct persistent_lazy_segment_tree_iter;
@@ -178,4 +179,170 @@ public:
     return node::bisect_from_right(root, r, lx, rx, f, id()).first;
   }
 };
+
+// ノードをpersistent_node_arenaに置き, 使わなくなったバージョンをrelease()で消せる版
+// バージョンの扱いはpersistent_segment_tree_arenaと同じ
+// 取得では遅延を下ろさず, 祖先の作用を合成して持ちながら降りる(読むだけではノードを作らない)
+template<typename monoid>
+struct persistent_lazy_segment_tree_arena{
+  using Val = typename monoid::Val;
+  using Lazy = typename monoid::Lazy;
+  static constexpr auto id = monoid::id;
+  static constexpr auto id_lazy = monoid::id_lazy;
+  static constexpr auto merge = monoid::merge;
+  static constexpr auto apply = monoid::apply;
+  static constexpr auto propagate_lazy = monoid::propagate;
+private:
+  struct elem{
+    Val sum;
+    Lazy lazy;
+  };
+  int lx, rx;
+  persistent_node_arena<elem> pool;
+  // xの後にyを作用させる
+  static Lazy compose(Lazy x, Lazy y){
+    return y == id_lazy() ? x : propagate_lazy(x, y);
+  }
+  static Val act(Val s, Lazy x, int l, int r){
+    return x == id_lazy() ? s : apply(s, x, l, r);
+  }
+  Val sum(int v)const{
+    return pool[v].val.sum;
+  }
+  // vにxを作用させたもの(参照1)
+  int with_lazy(int v, Lazy x, int l, int r){
+    if(x == id_lazy()) return pool.retain(v);
+    int u = pool.copy(v);
+    elem e = pool[u].val;
+    pool[u].val = elem{apply(e.sum, x, l, r), compose(e.lazy, x)};
+    return u;
+  }
+  // vの子にvの遅延を作用させたもの
+  std::pair<int, int> children(int v, int l, int mid, int r){
+    Lazy x = pool[v].val.lazy;
+    int cl = pool[v].l, cr = pool[v].r;
+    return {with_lazy(cl, x, l, mid), with_lazy(cr, x, mid, r)};
+  }
+  int make(int cl, int cr){
+    return pool.make(cl, cr, elem{merge(sum(cl), sum(cr)), id_lazy()});
+  }
+  int set(int v, int k, Val x, int l, int r){
+    if(r - l == 1) return pool.make(0, 0, elem{x, id_lazy()});
+    int mid = ((long long)l + r) >> 1;
+    auto [cl, cr] = children(v, l, mid, r);
+    int t;
+    if(mid <= k) t = set(cr, k, x, mid, r), pool.release(cr), cr = t;
+    else t = set(cl, k, x, l, mid), pool.release(cl), cl = t;
+    return make(cl, cr);
+  }
+  int update(int v, int a, int b, Lazy x, int l, int r){
+    if(r <= a || b <= l) return pool.retain(v);
+    if(a <= l && r <= b) return with_lazy(v, x, l, r);
+    int mid = ((long long)l + r) >> 1;
+    auto [cl, cr] = children(v, l, mid, r);
+    int tl = update(cl, a, b, x, l, mid), tr = update(cr, a, b, x, mid, r);
+    pool.release(cl);
+    pool.release(cr);
+    return make(tl, tr);
+  }
+  Val get(int v, int k, int l, int r)const{
+    Lazy acc = id_lazy();
+    while(v && r - l > 1){
+      acc = compose(pool[v].val.lazy, acc);
+      int mid = ((long long)l + r) >> 1;
+      if(mid <= k) v = pool[v].r, l = mid;
+      else v = pool[v].l, r = mid;
+    }
+    return act(sum(v), acc, k, k + 1);
+  }
+  Val query(int v, int a, int b, int l, int r, Lazy acc)const{
+    if(b <= l || r <= a) return id();
+    if(a <= l && r <= b) return act(sum(v), acc, l, r);
+    acc = compose(pool[v].val.lazy, acc);
+    int mid = ((long long)l + r) >> 1;
+    return merge(query(pool[v].l, a, b, l, mid, acc), query(pool[v].r, a, b, mid, r, acc));
+  }
+  template<typename F>
+  std::pair<int, Val> bisect_from_left(int v, const int l, int x, int y, const F &f, Val ok, Lazy acc)const{
+    if(y <= l) return {-1, ok};
+    if(l <= x){
+      Val m = merge(ok, act(sum(v), acc, x, y));
+      if(!f(m)) return {-1, m};
+      if(y - x == 1) return {x, m};
+    }
+    acc = compose(pool[v].val.lazy, acc);
+    int mid = (x + y) >> 1;
+    auto p = bisect_from_left(pool[v].l, l, x, mid, f, ok, acc);
+    if(p.first != -1) return p;
+    return bisect_from_left(pool[v].r, l, mid, y, f, p.second, acc);
+  }
+  template<typename F>
+  std::pair<int, Val> bisect_from_right(int v, const int r, int x, int y, const F &f, Val ok, Lazy acc)const{
+    if(r < x) return {-1, ok};
+    if(y <= r + 1){
+      Val m = merge(act(sum(v), acc, x, y), ok);
+      if(!f(m)) return {-1, m};
+      if(y - x == 1) return {x, m};
+    }
+    acc = compose(pool[v].val.lazy, acc);
+    int mid = (x + y) >> 1;
+    auto p = bisect_from_right(pool[v].r, r, mid, y, f, ok, acc);
+    if(p.first != -1) return p;
+    return bisect_from_right(pool[v].l, r, x, mid, f, p.second, acc);
+  }
+public:
+  persistent_lazy_segment_tree_arena(int minx, int maxx): lx(minx), rx(maxx), pool(elem{id(), id_lazy()}){
+    assert(lx < rx);
+  }
+  // 全て単位元のバージョン
+  int empty()const{
+    return 0;
+  }
+  int set(int v, int k, Val x){
+    assert(lx <= k && k < rx);
+    return set(v, k, x, lx, rx);
+  }
+  int update(int v, int l, int r, Lazy x){
+    assert(lx <= l && r <= rx);
+    return update(v, l, r, x, lx, rx);
+  }
+  Val get(int v, int k)const{
+    assert(lx <= k && k < rx);
+    return get(v, k, lx, rx);
+  }
+  Val query(int v, int l, int r)const{
+    assert(lx <= l && r <= rx);
+    return query(v, l, r, lx, rx, id_lazy());
+  }
+  // f(sum[l, r])がtrueになる最左のr. ない場合は-1
+  template<typename F>
+  int bisect_from_left(int v, int l, const F &f)const{
+    assert(lx <= l && l < rx);
+    assert(!f(id()));
+    return bisect_from_left(v, l, lx, rx, f, id(), id_lazy()).first;
+  }
+  // f(sum[l, r])がtrueになる最右のl. ない場合は-1
+  template<typename F>
+  int bisect_from_right(int v, int r, const F &f)const{
+    assert(lx <= r && r < rx);
+    assert(!f(id()));
+    return bisect_from_right(v, r, lx, rx, f, id(), id_lazy()).first;
+  }
+  int retain(int v){
+    return pool.retain(v);
+  }
+  void release(int v){
+    pool.release(v);
+  }
+  // ノードn個分を確保する, 生きているノードがn個以下の間は再確保されない
+  void reserve(int n){
+    pool.reserve(n);
+  }
+  int num_nodes()const{
+    return pool.size();
+  }
+  void compact(std::vector<int> &roots){
+    pool.compact(roots);
+  }
+};
 #endif
\ No newline at end of file
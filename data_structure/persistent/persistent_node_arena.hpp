@@ -0,0 +1,111 @@
+#ifndef _PERSISTENT_NODE_ARENA_H_
+#define _PERSISTENT_NODE_ARENA_H_
+#include <vector>
+#include <cassert>
+#include <cstdint>
+
+// 永続二分木のノードのプール, ノード番号は32bit, 0は空の木(値はz)
+// 参照カウント := 親からの辺の数 + 外から持たれている数(バージョンの根)
+// 0になったノードは空きリストに戻し, 子の参照カウントを減らす
+// メモリ: 生きているノード数 * (12byte + sizeof(T))
+template<typename T>
+struct persistent_node_arena{
+  struct node{
+    int l, r;
+    uint32_t ref;
+    T val;
+  };
+private:
+  std::vector<node> v;
+  std::vector<int> fr; // 空いている番号
+  std::vector<int> st;
+  bool reserved = false; // reserveした後はvを再確保しない
+public:
+  persistent_node_arena(){}
+  persistent_node_arena(T z): v{node{0, 0, 1, z}}{}
+  // 参照カウント1のノード, l, rの参照は新しいノードに移る
+  int make(int l, int r, T val){
+    if(!fr.empty()){
+      int k = fr.back();
+      fr.pop_back();
+      v[k] = node{l, r, 1, val};
+      return k;
+    }
+    // reserveした数を超えると再確保され, 読み込み中のスレッドがあれば解放済みのメモリを読む
+    assert(!reserved || v.size() < v.capacity());
+    v.push_back(node{l, r, 1, val});
+    return (int)v.size() - 1;
+  }
+  // 子の参照を増やしてコピー
+  int copy(int k){
+    retain(v[k].l);
+    retain(v[k].r);
+    return make(v[k].l, v[k].r, v[k].val);
+  }
+  const node &operator[](int k)const{
+    return v[k];
+  }
+  node &operator[](int k){
+    return v[k];
+  }
+  int retain(int k){
+    if(k) v[k].ref++;
+    return k;
+  }
+  void release(int k){
+    if(!k) return;
+    st.push_back(k);
+    while(!st.empty()){
+      int x = st.back();
+      st.pop_back();
+      if(!x || --v[x].ref) continue;
+      st.push_back(v[x].l);
+      st.push_back(v[x].r);
+      fr.push_back(x);
+    }
+  }
+  // ノードn個分(0を除く)を確保する, 生きているノードがn個以下の間は再確保されない
+  // 以降, 生きているノードがn個を超えるとmakeのassertで止まる(NDEBUGでは未定義動作)
+  void reserve(int n){
+    reserved = true;
+    v.reserve(n + 1);
+    fr.reserve(n);
+  }
+  // 生きているノード数(0を除く)
+  int size()const{
+    return (int)v.size() - 1 - (int)fr.size();
+  }
+  // 確保しているノード数(0を除く)
+  int capacity()const{
+    return (int)v.size() - 1;
+  }
+  // rootsから行きがけ順に番号を付け直して詰める, 空きリストは無くなる, reserveした分は確保したまま
+  // rootsは外から持たれている全ての根(同じ根が複数回あってもいい)で, 番号を書き換える
+  void compact(std::vector<int> &roots){
+    std::vector<int> id(v.size(), -1);
+    std::vector<node> w{v[0]};
+    w.reserve(reserved ? v.capacity() : size() + 1);
+    id[0] = 0;
+    // 葉の側から書き込めないので, 新しい番号だけ先に決めて子は後で直す
+    for(int rt : roots){
+      if(id[rt] != -1) continue;
+      st.push_back(rt);
+      while(!st.empty()){
+        int x = st.back();
+        st.pop_back();
+        if(id[x] != -1) continue;
+        id[x] = w.size();
+        w.push_back(v[x]);
+        st.push_back(v[x].r);
+        st.push_back(v[x].l);
+      }
+    }
+    assert((int)w.size() == size() + 1); // rootsに無い根があると消してしまう
+    for(auto &x : w) x.l = id[x.l], x.r = id[x.r];
+    for(int &rt : roots) rt = id[rt];
+    v.swap(w);
+    if(!reserved) v.shrink_to_fit();
+    std::vector<int>().swap(fr);
+  }
+};
+#endif
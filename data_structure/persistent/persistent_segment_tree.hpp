@@ -5,6 +5,7 @@
 #include <limits>
 #include <cassert>
 #include "../../algebraic_structure/monoid.hpp"
+#include "persistent_node_arena.hpp"
 
 template<typename monoid>
 struct persistent_segment_tree_iter;
@@ -134,4 +135,123 @@ public:
     return node::bisect_from_right(root, r, lx, rx, f, id()).first;
   }
 };
+
+// ノードをpersistent_node_arenaに置き, 使わなくなったバージョンをrelease()で消せる版
+// バージョンは根のノード番号(int), 0は全て単位元の木
+// set等が返すバージョンは呼び出し側が1つ参照を持っていて, 不要になったらreleaseする(複製する場合はretain)
+// 生きているバージョンの数が抑えられていればメモリも抑えられる
+template<typename monoid>
+struct persistent_segment_tree_arena{
+  using Val = typename monoid::Val;
+  static constexpr auto id = monoid::id;
+  static constexpr auto merge = monoid::merge;
+private:
+  int lx, rx;
+  persistent_node_arena<Val> pool;
+  Val sum(int v)const{
+    return pool[v].val;
+  }
+  int set(int v, int k, Val x, int l, int r){
+    if(r - l == 1) return pool.make(0, 0, x);
+    int mid = ((long long)l + r) >> 1;
+    int cl = pool[v].l, cr = pool[v].r;
+    if(mid <= k) cr = set(cr, k, x, mid, r), pool.retain(cl);
+    else cl = set(cl, k, x, l, mid), pool.retain(cr);
+    return pool.make(cl, cr, merge(sum(cl), sum(cr)));
+  }
+  Val get(int v, int k, int l, int r)const{
+    while(v && r - l > 1){
+      int mid = ((long long)l + r) >> 1;
+      if(mid <= k) v = pool[v].r, l = mid;
+      else v = pool[v].l, r = mid;
+    }
+    return sum(v);
+  }
+  Val query(int v, int a, int b, int l, int r)const{
+    if(!v || b <= l || r <= a) return id();
+    if(a <= l && r <= b) return sum(v);
+    int mid = ((long long)l + r) >> 1;
+    return merge(query(pool[v].l, a, b, l, mid), query(pool[v].r, a, b, mid, r));
+  }
+  template<typename F>
+  std::pair<int, Val> bisect_from_left(int v, const int l, int x, int y, const F &f, Val ok)const{
+    if(y <= l) return {-1, ok};
+    if(l <= x){
+      Val m = merge(ok, sum(v));
+      if(!f(m)) return {-1, m};
+      if(y - x == 1) return {x, m};
+    }
+    int mid = (x + y) >> 1;
+    auto p = bisect_from_left(pool[v].l, l, x, mid, f, ok);
+    if(p.first != -1) return p;
+    return bisect_from_left(pool[v].r, l, mid, y, f, p.second);
+  }
+  template<typename F>
+  std::pair<int, Val> bisect_from_right(int v, const int r, int x, int y, const F &f, Val ok)const{
+    if(r < x) return {-1, ok};
+    if(y <= r + 1){
+      Val m = merge(sum(v), ok);
+      if(!f(m)) return {-1, m};
+      if(y - x == 1) return {x, m};
+    }
+    int mid = (x + y) >> 1;
+    auto p = bisect_from_right(pool[v].r, r, mid, y, f, ok);
+    if(p.first != -1) return p;
+    return bisect_from_right(pool[v].l, r, x, mid, f, p.second);
+  }
+public:
+  persistent_segment_tree_arena(int minx, int maxx): lx(minx), rx(maxx), pool(id()){
+    assert(lx < rx);
+  }
+  // 全て単位元のバージョン
+  int empty()const{
+    return 0;
+  }
+  // vのk番目をxにしたバージョン
+  int set(int v, int k, Val x){
+    assert(lx <= k && k < rx);
+    return set(v, k, x, lx, rx);
+  }
+  Val get(int v, int k)const{
+    assert(lx <= k && k < rx);
+    return get(v, k, lx, rx);
+  }
+  Val query(int v, int l, int r)const{
+    assert(lx <= l && r <= rx);
+    return query(v, l, r, lx, rx);
+  }
+  // f(sum[l, r])がtrueになる最左のr. ない場合は-1
+  template<typename F>
+  int bisect_from_left(int v, int l, const F &f)const{
+    assert(lx <= l && l < rx);
+    assert(!f(id()));
+    return bisect_from_left(v, l, lx, rx, f, id()).first;
+  }
+  // f(sum[l, r])がtrueになる最右のl. ない場合は-1
+  template<typename F>
+  int bisect_from_right(int v, int r, const F &f)const{
+    assert(lx <= r && r < rx);
+    assert(!f(id()));
+    return bisect_from_right(v, r, lx, rx, f, id()).first;
+  }
+  int retain(int v){
+    return pool.retain(v);
+  }
+  // vの参照を1つ減らし, どのバージョンからも使われなくなったノードを消す
+  void release(int v){
+    pool.release(v);
+  }
+  // ノードn個分を確保する, 生きているノードがn個以下の間は再確保されない(version_publisherで読み込みと並行して書ける)
+  void reserve(int n){
+    pool.reserve(n);
+  }
+  // 生きているノード数
+  int num_nodes()const{
+    return pool.size();
+  }
+  // rootsは持っている全てのバージョン, ノードを行きがけ順に詰めて番号を書き換える
+  void compact(std::vector<int> &roots){
+    pool.compact(roots);
+  }
+};
 #endif
\ No newline at end of file
@@ -1,14 +1,19 @@
 #ifndef _ROLLBACK_ARRAY_H_
 #define _ROLLBACK_ARRAY_H_
 #include <vector>
-#include <stack>
+#include <cassert>
+#include "../../misc/binary_io.hpp"
 
 template<typename T>
 struct rollback_array{
 private:
   static constexpr T z = 0;// Tの零元
+  struct op{
+    int k; // 書き換えられたインデックス, -1ならbookmark
+    T x;   // 以前の値
+  };
   std::vector<T> v;
-  std::stack<std::pair<int, T>> h;// {書き換えられたインデックス, 以前の値}
+  std::vector<op> h;
 public:
   rollback_array(){}
   rollback_array(int n, T val): v(n, val){}
@@ -18,20 +23,20 @@ public:
     return v.size();
   }
   void set(int k, T x){
-    h.push({k, v[k]});
+    h.push_back({k, v[k]});
     v[k] = x;
   }
   T get(int k){
     return v[k];
   }
   void bookmark(){
-    h.push({-1, z});
+    h.push_back({-1, z});
   }
   // 1つ前のbookmarkまで戻して消す
   void rollback_bookmark(){
     while(!h.empty()){
-      auto [k, x] = h.top();
-      h.pop();
+      auto [k, x] = h.back();
+      h.pop_back();
       if(k == -1) break;
       v[k] = x;
     }
@@ -39,13 +44,39 @@ public:
   // bookmarkを無視して1つ戻す
   void rollback(){
     while(!h.empty()){
-      auto [k, x] = h.top();
-      h.pop();
+      auto [k, x] = h.back();
+      h.pop_back();
       if(k != -1){
         v[k] = x;
         break;
       }
     }
   }
+  // 今の状態を表す値(履歴の長さ)
+  int checkpoint()const{
+    return h.size();
+  }
+  // checkpoint()の時点まで戻し, それ以降の履歴を消す
+  void rollback_to(int c){
+    assert(0 <= c && c <= (int)h.size());
+    while((int)h.size() > c){
+      auto [k, x] = h.back();
+      h.pop_back();
+      if(k != -1) v[k] = x;
+    }
+  }
+  // 今の状態より前には戻れなくする
+  void clear_history(){
+    std::vector<op>().swap(h);
+  }
+  // 値と履歴をそのまま書き出す, Tはtrivially copyable
+  void save(std::ostream &os)const{
+    write_binary(os, v);
+    write_binary(os, h);
+  }
+  void load(std::istream &is){
+    read_binary(is, v);
+    read_binary(is, h);
+  }
 };
-#endif
\ No newline at end of file
+#endif
@@ -2,21 +2,26 @@
 #define _ROLLBACK_DEQUE_H_
 #include <vector>
 #include <deque>
-#include <stack>
+#include <cassert>
+#include "../../misc/binary_io.hpp"
 
 template<typename T>
 struct rollback_deque{
 private:
   static constexpr T z = 0;// Tの零元
   std::deque<T> v;
-  // {クエリタイプ, 以前の値}
-  // 0以上: 書き込み
-  // -1: bookmark
-  // -2: pop_front
-  // -3: push_front
-  // -4: pop_back
-  // -5: push_back
-  std::stack<std::pair<int, T>> h;
+  struct op{
+    // クエリタイプ
+    // 0以上: 書き込み
+    // -1: bookmark
+    // -2: pop_front
+    // -3: push_front
+    // -4: pop_back
+    // -5: push_back
+    int k;
+    T x; // 以前の値
+  };
+  std::vector<op> h;
 public:
   rollback_deque(){}
   rollback_deque(int n, T val): v(n, val){}
@@ -33,29 +38,29 @@ public:
     return v.back();
   }
   void set(int k, T x){
-    h.push({k, v[k]});
+    h.push_back({k, v[k]});
     v[k] = x;
   }
   T get(int k){
     return v[k];
   }
   void bookmark(){
-    h.push({-1, 0});
+    h.push_back({-1, 0});
   }
   void pop_front(){
-    h.push({-2, v.front()});
+    h.push_back({-2, v.front()});
     v.pop_front();
   }
   void push_front(T x){
-    h.push({-3, z});
+    h.push_back({-3, z});
     v.push_front(x);
   }
   void pop_back(){
-    h.push({-4, v.back()});
+    h.push_back({-4, v.back()});
     v.pop_back();
   }
   void push_back(T x){
-    h.push({-5, z});
+    h.push_back({-5, z});
     v.push_back(x);
   }
   void process(int k, T x){
@@ -71,8 +76,8 @@ public:
   // 1つ前のbookmarkまで戻して消す
   void rollback_bookmark(){
     while(!h.empty()){
-      auto [k, x] = h.top();
-      h.pop();
+      auto [k, x] = h.back();
+      h.pop_back();
       process(k, x);
       if(k == -1) break;
     }
@@ -80,11 +85,39 @@ public:
   // bookmarkを無視して1つ戻す
   void rollback(){
     while(!h.empty()){
-      auto [k, x] = h.top();
-      h.pop();
+      auto [k, x] = h.back();
+      h.pop_back();
       process(k, x);
       if(k != -1) break;
     }
   }
+  // 今の状態を表す値(履歴の長さ)
+  int checkpoint()const{
+    return h.size();
+  }
+  // checkpoint()の時点まで戻し, それ以降の履歴を消す
+  void rollback_to(int c){
+    assert(0 <= c && c <= (int)h.size());
+    while((int)h.size() > c){
+      auto [k, x] = h.back();
+      h.pop_back();
+      process(k, x);
+    }
+  }
+  // 今の状態より前には戻れなくする
+  void clear_history(){
+    std::vector<op>().swap(h);
+  }
+  // 値と履歴をそのまま書き出す, Tはtrivially copyable
+  void save(std::ostream &os)const{
+    write_binary(os, std::vector<T>(v.begin(), v.end()));
+    write_binary(os, h);
+  }
+  void load(std::istream &is){
+    std::vector<T> tmp;
+    read_binary(is, tmp);
+    v.assign(tmp.begin(), tmp.end());
+    read_binary(is, h);
+  }
 };
 #endif
\ No newline at end of file
@@ -1,26 +1,41 @@
 #ifndef _ROLLBACK_SEGMENT_TREE_H_
 #define _ROLLBACK_SEGMENT_TREE_H_
-#include "rollback_array.hpp"
 #include "../../algebraic_structure/monoid.hpp"
+#include "../../misc/binary_io.hpp"
+#include "../../misc/ceillog2.hpp"
 #include <vector>
 #include <cassert>
 #include <cstdint>
 #include <numeric>
-#include <stack>
 
 template<typename monoid>
 struct rollback_segment_tree{
   using Val = typename monoid::Val;
   static constexpr auto id = monoid::id;
   static constexpr auto merge = monoid::merge;
+  struct op{
+    int k; // 書き換えた位置, -1ならbookmark
+    Val x; // 以前の値
+  };
   int N, M;
   std::vector<Val> sum;
-  rollback_array<Val> hist;
+  std::vector<op> hist;
+private:
+  // 履歴に残さずに書き換える(set, rollbackの中だけで使う)
+  void update(int k, Val x){
+    k += M - 1;
+    sum[k] = x;
+    while(k){
+      k = (k - 1) >> 1;
+      sum[k] = merge(sum[k * 2 + 1], sum[k * 2 + 2]);
+    }
+  }
+public:
   rollback_segment_tree(){}
   rollback_segment_tree(int n):
-  N(n), M(ceil_pow(N, 2)), sum(2 * M - 1, id()){}
+  N(n), M(1 << ceillog2(N)), sum(2 * M - 1, id()){}
   rollback_segment_tree(const std::vector<Val> v):
-  N(v.size()), M(ceil_pow(N, 2)), sum(2 * M - 1, id()){
+  N(v.size()), M(1 << ceillog2(N)), sum(2 * M - 1, id()){
     std::copy(v.begin(), v.end(), sum.begin() + M - 1);
     for(int i = M - 2; i >= 0; i--){
       sum[i] = merge(sum[i * 2 + 1], sum[i * 2 + 2]);
@@ -28,13 +43,8 @@ struct rollback_segment_tree{
   }
   void set(int k, Val x){
     assert(0 <= k && k < N);
-    hist.set(k, x);
-    k += M - 1;
-    sum[k] = x;
-    while(k){
-      k = (k - 1) >> 1;
-      sum[k] = merge(sum[k * 2 + 1], sum[k * 2 + 2]);
-    }
+    hist.push_back({k, sum[M - 1 + k]});
+    update(k, x);
   }
   Val get(int k){
     assert(0 <= k && k < N);
@@ -103,10 +113,46 @@ struct rollback_segment_tree{
     return -1;
   }
   void bookmark(){
-    hist.bookmark();
+    hist.push_back({-1, id()});
   }
+  // 1つ前のbookmarkまで戻して消す
   void rollback(){
-    for(auto [k, x] : hist.rollback_bookmark_diff()) set(k, x);
+    while(!hist.empty()){
+      auto [k, x] = hist.back();
+      hist.pop_back();
+      if(k == -1) break;
+      update(k, x);
+    }
+  }
+  // 今の状態を表す値(履歴の長さ)
+  int checkpoint()const{
+    return hist.size();
+  }
+  // checkpoint()の時点まで戻し, それ以降の履歴を消す
+  void rollback_to(int c){
+    assert(0 <= c && c <= (int)hist.size());
+    while((int)hist.size() > c){
+      auto [k, x] = hist.back();
+      hist.pop_back();
+      if(k != -1) update(k, x);
+    }
+  }
+  // 今の状態より前には戻れなくする
+  void clear_history(){
+    std::vector<op>().swap(hist);
+  }
+  // 値と履歴をそのまま書き出す, Valはtrivially copyable
+  void save(std::ostream &os)const{
+    write_binary(os, N);
+    write_binary(os, M);
+    write_binary(os, sum);
+    write_binary(os, hist);
+  }
+  void load(std::istream &is){
+    read_binary(is, N);
+    read_binary(is, M);
+    read_binary(is, sum);
+    read_binary(is, hist);
   }
 };
 #endif
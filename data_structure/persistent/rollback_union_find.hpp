@@ -5,6 +5,7 @@
 #include <numeric>
 #include <cassert>
 #include <queue>
+#include "../../misc/binary_io.hpp"
 
 struct rollback_union_find{
   int n, pos, cc;
@@ -50,6 +51,36 @@ struct rollback_union_find{
   int count_cc(){
     return cc;
   }
+  // 今の状態を表す値(履歴の長さ)
+  int checkpoint()const{
+    return pos;
+  }
+  // checkpoint()の時点まで戻す
+  void rollback_to(int c){
+    assert(0 <= c && c <= pos);
+    while(pos > c) rollback();
+  }
+  // 今の状態より前には戻れなくする
+  void clear_history(){
+    pos = 0;
+    std::vector<int>().swap(history);
+  }
+  void save(std::ostream &os)const{
+    write_binary(os, n);
+    write_binary(os, pos);
+    write_binary(os, cc);
+    write_binary(os, par);
+    write_binary(os, sz);
+    write_binary(os, std::vector<int>(history.begin(), history.begin() + pos));
+  }
+  void load(std::istream &is){
+    read_binary(is, n);
+    read_binary(is, pos);
+    read_binary(is, cc);
+    read_binary(is, par);
+    read_binary(is, sz);
+    read_binary(is, history);
+  }
 };
 
 struct rollback_union_find_enumerate{
@@ -99,6 +130,49 @@ struct rollback_union_find_enumerate{
   int count_cc(){
     return cc;
   }
+  // 今の状態を表す値(履歴の長さ)
+  int checkpoint()const{
+    return pos;
+  }
+  // checkpoint()の時点まで戻す
+  void rollback_to(int c){
+    assert(0 <= c && c <= pos);
+    while(pos > c) rollback();
+  }
+  // 今の状態より前には戻れなくする
+  void clear_history(){
+    pos = 0;
+    std::vector<int>().swap(history);
+  }
+  void save(std::ostream &os)const{
+    write_binary(os, n);
+    write_binary(os, pos);
+    write_binary(os, cc);
+    write_binary(os, par);
+    write_binary(os, sz);
+    write_binary(os, std::vector<int>(history.begin(), history.begin() + pos));
+  }
+  void load(std::istream &is){
+    read_binary(is, n);
+    read_binary(is, pos);
+    read_binary(is, cc);
+    read_binary(is, par);
+    read_binary(is, sz);
+    read_binary(is, history);
+    // clear_history()より前に繋いだ子をparから戻し, その後に履歴の順に子を追加する(rollbackで末尾から消せるように)
+    ch.assign(n, {});
+    std::vector<bool> in_history(n, false);
+    for(int i = 0; i < pos; i++){
+      if(history[i] >= n) continue;
+      in_history[history[++i]] = true;
+    }
+    for(int v = 0; v < n; v++) if(par[v] != -1 && !in_history[v]) ch[par[v]].push_back(v);
+    for(int i = 0; i < pos; i++){
+      if(history[i] >= n) continue;
+      ch[history[i]].push_back(history[i + 1]);
+      i++;
+    }
+  }
   // uを含む連結成分の全要素
   std::vector<int> enumerate(int u){
     std::vector<int> ret;
@@ -0,0 +1,101 @@
+#ifndef _VERSION_PUBLISHER_H_
+#define _VERSION_PUBLISHER_H_
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <limits>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+
+// 永続データ構造のバージョン(*_iter)を, 書き込み1スレッドと読み込み複数スレッドで共有する
+// 最新のバージョンはatomicなポインタで持つ
+// 読み込み: 自分のスロットに今のエポックを書く -> 最新のバージョンを読む -> fを呼ぶ -> スロットを0に戻す (wait-free)
+// 書き込み: ポインタを交換してエポックを1進める, 古いバージョンは交換前のエポックで読んでいるスレッドが居なくなってから消す(待たない)
+// 書き込みが既存のノードを書き換えず, 新しいノードを個別に確保する構造(persistent_segment_tree, persistent_set等)で使える
+// 消す時に解放されるのはIterのコピーだけで, ノードは解放されない(上の構造はノードを解放しない)
+// publish(x, on_reclaim)とすると, xを消す時(読み込み中のスレッドが居なくなった後)にon_reclaim()を呼ぶ
+// persistent_segment_tree_arena, persistent_lazy_segment_tree_arenaはreserveして再確保されないようにすれば, バージョンを根の番号にしてon_reclaimでreleaseできる
+// 生きているノード(回収待ちのバージョンのノードも含む)がreserveした数を超えるのは未定義動作(再確保で読み込み中のメモリが解放される, debugビルドではassertで止まる)
+// (消したノードは読み込み中のスレッドが居なくなってから空きリストに戻るので, 再利用されても読み込みとぶつからない)
+// reserveしていない*_arenaやpersistent_arrayは書き込みで再確保されるので使えない
+// persistent_lazy_segment_tree(arenaでない方)は読み込みでもノードを書き換えるので使えない
+template<typename Iter>
+struct version_publisher{
+private:
+  struct alignas(64) slot{
+    std::atomic<uint64_t> e{0}; // 読み込み中ならその時のエポック, そうでなければ0
+  };
+  struct retired_version{
+    Iter *p;
+    uint64_t e; // 交換前のエポック
+    std::function<void()> f;
+  };
+  std::atomic<Iter*> cur;
+  std::atomic<uint64_t> epoch;
+  std::vector<slot> slots;
+  std::function<void()> cur_f; // 最新のバージョンのon_reclaim
+  std::vector<retired_version> retired;
+  static void destroy(retired_version &r){
+    delete r.p;
+    if(r.f) r.f();
+  }
+  struct leave{
+    std::atomic<uint64_t> &e;
+    ~leave(){ e.store(0, std::memory_order_release); }
+  };
+public:
+  // 読み込むスレッドは0, 1, ..., readers - 1の番号を使う
+  version_publisher(const Iter &x, int readers, std::function<void()> on_reclaim = nullptr): cur(new Iter(x)), epoch(1), slots(readers), cur_f(on_reclaim){
+    assert(readers > 0);
+  }
+  version_publisher(const version_publisher&) = delete;
+  version_publisher &operator=(const version_publisher&) = delete;
+  // 読み込み中のスレッドが無い状態で呼ぶ, 残っている全てのバージョンのon_reclaimも呼ぶ
+  ~version_publisher(){
+    for(auto &r : retired) destroy(r);
+    retired_version r{cur.load(), 0, cur_f};
+    destroy(r);
+  }
+  int readers()const{
+    return slots.size();
+  }
+  // 最新のバージョンのコピーxについてf(x)を返す, 番号idのスレッドから呼ぶ
+  template<typename F>
+  decltype(auto) read(int id, F f){
+    assert(0 <= id && id < (int)slots.size());
+    auto &e = slots[id].e;
+    assert(!e.load(std::memory_order_relaxed)); // 入れ子にしない
+    e.store(epoch.load());
+    leave g{e};
+    Iter x = *cur.load();
+    return f(x);
+  }
+  // 以下は書き込むスレッドだけが呼ぶ
+  Iter latest()const{
+    return *cur.load(std::memory_order_relaxed);
+  }
+  // これまでに公開した回数
+  uint64_t published()const{
+    return epoch.load(std::memory_order_relaxed) - 1;
+  }
+  // xを最新のバージョンにする, on_reclaimはxを消す時に書き込むスレッドで呼ばれる
+  void publish(const Iter &x, std::function<void()> on_reclaim = nullptr){
+    Iter *old = cur.exchange(new Iter(x));
+    retired.push_back({old, epoch.fetch_add(1), std::move(cur_f)});
+    cur_f = std::move(on_reclaim);
+    reclaim();
+  }
+  // 交換前のエポックが, 読み込み中の全てのスレッドのエポック未満のものを消す
+  void reclaim(){
+    uint64_t mn = std::numeric_limits<uint64_t>::max();
+    for(auto &s : slots){
+      uint64_t e = s.e.load();
+      if(e) mn = std::min(mn, e);
+    }
+    auto it = std::partition(retired.begin(), retired.end(), [&](const retired_version &r){ return r.e >= mn; });
+    for(auto i = it; i != retired.end(); i++) destroy(*i);
+    retired.erase(it, retired.end());
+  }
+};
+#endif
@@ -0,0 +1,201 @@
+#ifndef _RMQ_SUCCINCT_H_
+#define _RMQ_SUCCINCT_H_
+#include <vector>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include "sparse_table.hpp"
+#include "../bit_sequence/bitvector.hpp"
+
+// 値を持たずに最小値の位置を返すrmq
+// 左から見て, 自分より大きい値をpopする度に0, pushで1を書いたビット列(デカルト木の括弧列, 2Nbit)
+// iの'('の位置をo_i, 位置qまでの(1の数 - 0の数)をE(q)とすると, l < rについて
+// min E(o_l + 1 ... o_r)がE(o_l)以上 -> 答えはl, そうでなければ最右の最小の位置の次の'('の頂点
+// Eの区間最小は 単語(64bit, 差分をint8) -> ブロック(8単語, int16) -> スーパーブロック(64単語, sparse_table) で求める
+// 合計 約3.5Nbit
+struct rmq_succinct{
+private:
+  static constexpr int W = 64, B = 8, S = 64; // 1ブロック = B単語, 1スーパーブロック = S単語
+  int n;
+  bitvector_succinct bp;
+  std::vector<int8_t> word_min;   // 単語内の接頭辞での最小(単語の直前との差分)
+  std::vector<int16_t> block_min; // ブロック内の最小(ブロックの直前との差分)
+  static constexpr long long min_func(long long a, long long b){ return std::min(a, b); }
+  static constexpr long long id(){ return std::numeric_limits<long long>::max(); }
+  sparse_table<long long, min_func, id> super_min; // (最小値 << 32) | (2^31 - 1 - スーパーブロック番号)
+  struct byte_table{
+    std::array<int8_t, 256> mn, pos, sum;
+    byte_table(){
+      for(int x = 0; x < 256; x++){
+        int e = 0;
+        mn[x] = 9;
+        for(int k = 0; k < 8; k++){
+          e += ((x >> k) & 1) ? 1 : -1;
+          if(e <= mn[x]) mn[x] = e, pos[x] = k + 1;
+        }
+        sum[x] = e;
+      }
+    }
+  };
+  static const byte_table &table(){
+    static byte_table t;
+    return t;
+  }
+  // 長さtの接頭辞の(1の数 - 0の数)
+  int excess(int t)const{
+    return 2 * bp.rank1(t) - t;
+  }
+  struct cand{
+    int val, kind, id; // kind 0: 長さid, 1: 単語, 2: ブロック, 3: スーパーブロック
+  };
+  // 同じ単語内の長さ[L, R]の接頭辞を走査, 値が同じなら右を優先
+  void scan_word(int L, int R, cand &best)const{
+    const auto &tb = table();
+    int e = excess(L - 1);
+    uint64_t x = bp.words[(L - 1) >> 6];
+    int q = L - 1;
+    while(q < R){
+      if((q & 7) == 0 && q + 8 <= R){
+        int y = (x >> (q & 63)) & 255;
+        if(e + tb.mn[y] <= best.val) best = {e + tb.mn[y], 0, q + tb.pos[y]};
+        e += tb.sum[y];
+        q += 8;
+      }else{
+        e += ((x >> (q & 63)) & 1) ? 1 : -1;
+        q++;
+        if(e <= best.val) best = {e, 0, q};
+      }
+    }
+  }
+  int resolve(cand c)const{
+    if(c.kind == 3){
+      int b = c.id * (S / B);
+      for(int k = S / B - 1; k >= 0; k--){
+        int bb = b + k;
+        if(bb < (int)block_min.size() && excess(bb * B * W) + block_min[bb] == c.val){
+          c = {c.val, 2, bb};
+          break;
+        }
+      }
+    }
+    if(c.kind == 2){
+      int w = c.id * B;
+      for(int k = B - 1; k >= 0; k--){
+        int ww = w + k;
+        if(ww < (int)word_min.size() && excess(ww * W) + word_min[ww] == c.val){
+          c = {c.val, 1, ww};
+          break;
+        }
+      }
+    }
+    if(c.kind == 1){
+      cand d{std::numeric_limits<int>::max(), 0, 0};
+      scan_word(c.id * W + 1, c.id * W + W, d);
+      return d.id;
+    }
+    return c.id;
+  }
+  // E(t) (L <= t <= R)の最右の最小
+  int min_excess(int L, int R){
+    cand best{std::numeric_limits<int>::max(), 0, 0};
+    int wl = (L - 1) >> 6, wr = (R - 1) >> 6; // 長さtはビットt - 1で決まる
+    if(wl == wr){
+      scan_word(L, R, best);
+      return resolve(best);
+    }
+    scan_word(L, (wl + 1) * W, best);
+    auto add = [&](int val, int kind, int id){
+      if(val <= best.val) best = {val, kind, id};
+    };
+    auto add_words = [&](int a, int b){ // 単語[a, b)
+      for(int w = a; w < b; w++) add(excess(w * W) + word_min[w], 1, w);
+    };
+    auto add_blocks = [&](int a, int b){ // ブロック[a, b)
+      for(int k = a; k < b; k++) add(excess(k * B * W) + block_min[k], 2, k);
+    };
+    int a = wl + 1, b = wr; // 単語[a, b)が全て含まれる
+    if(a < b){
+      int ba = (a + B - 1) / B, bb = b / B;
+      if(ba >= bb){
+        add_words(a, b);
+      }else{
+        add_words(a, ba * B);
+        int sa = (ba + S / B - 1) / (S / B), sb = bb / (S / B);
+        if(sa >= sb){
+          add_blocks(ba, bb);
+        }else{
+          add_blocks(ba, sa * (S / B));
+          long long key = super_min.query(sa, sb);
+          add(key >> 32, 3, 0x7fffffff - int(key & 0xffffffff));
+          add_blocks(sb * (S / B), bb);
+        }
+        add_words(bb * B, b);
+      }
+    }
+    scan_word(wr * W + 1, R, best);
+    return resolve(best);
+  }
+public:
+  rmq_succinct(): n(0){}
+  template<typename T>
+  rmq_succinct(const std::vector<T> &v): rmq_succinct(v.size(), [&](int i){ return v[i]; }){}
+  // f(i) := i番目の値
+  template<typename F>
+  rmq_succinct(int n, F f): n(n){
+    std::vector<uint64_t> w;
+    std::vector<int> st;
+    long long len = 0;
+    auto push_bit = [&](bool b){
+      if((len & 63) == 0) w.push_back(0);
+      if(b) w.back() |= 1ULL << (len & 63);
+      len++;
+    };
+    for(int i = 0; i < n; i++){
+      auto x = f(i);
+      while(!st.empty() && x < f(st.back())){
+        st.pop_back();
+        push_bit(0);
+      }
+      st.push_back(i);
+      push_bit(1);
+    }
+    std::vector<int>().swap(st);
+    bp = bitvector_succinct(std::move(w), len);
+    int m = bp.words.size();
+    word_min.resize(m);
+    block_min.resize((m + B - 1) / B);
+    std::vector<long long> sm((m + S - 1) / S, id());
+    const auto &tb = table();
+    int e = 0, eb = 0, cur_b = 0;
+    for(int i = 0; i < m; i++){
+      if(i % B == 0) eb = e, cur_b = std::numeric_limits<int>::max();
+      int mn = std::numeric_limits<int>::max(), d = 0;
+      for(int k = 0; k < 8; k++){
+        int y = (bp.words[i] >> (8 * k)) & 255;
+        mn = std::min(mn, d + tb.mn[y]);
+        d += tb.sum[y];
+      }
+      word_min[i] = mn;
+      cur_b = std::min(cur_b, e - eb + mn);
+      block_min[i / B] = cur_b;
+      long long key = (long long)(e + mn) * (1LL << 32) + (0x7fffffff - i / S);
+      sm[i / S] = std::min(sm[i / S], key);
+      e += d;
+    }
+    super_min = sparse_table<long long, min_func, id>(sm);
+  }
+  int size()const{
+    return n;
+  }
+  // [l, r)の最小値の位置(最左), l >= rの場合-1
+  int query(int l, int r){
+    if(l >= r) return -1;
+    if(r - l == 1) return l;
+    int ol = bp.select1(l), oj = bp.select1(r - 1);
+    int t = min_excess(ol + 2, oj + 1);
+    if(excess(t) >= excess(ol + 1)) return l;
+    return bp.rank1(t);
+  }
+};
+#endif
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <iostream>
 #include <limits>
+#include <cstdint>
 
 template<typename T, T (*merge)(T, T), T (*id)()>
 struct sparse_table{
@@ -152,4 +153,62 @@ public:
     st_short.clear();
   }
 };
+
+// 線形メモリのrmq
+// 各iについて, iで終わる長さ64の窓の単調スタックをビットマスクで持つ(ビットk := i-kがスタックにある)
+// 64以下の区間はマスク1つ, それ以上は64ブロックのsparse_table + 両端の短い区間
+template<typename T>
+struct rmq_linear{
+private:
+  static constexpr T min_func(T a, T b){
+    return std::min(a, b);
+  }
+  static constexpr T id(){
+    return std::numeric_limits<T>::max();
+  }
+  static constexpr int block_size = 64;
+  static constexpr int block_size_log = 6;
+  std::vector<T> v;
+  std::vector<uint64_t> mask;
+  sparse_table<T, min_func, id> st;
+  // r - l <= 64
+  T query_short(int l, int r)const{
+    int d = r - 1 - l;
+    uint64_t m = mask[r - 1] & (d == 63 ? ~0ULL : (2ULL << d) - 1);
+    return v[r - 1 - (63 - __builtin_clzll(m))];
+  }
+public:
+  int n;
+  rmq_linear(): n(0){}
+  rmq_linear(const std::vector<T> &_v): v(_v), mask(_v.size()), n(_v.size()){
+    if(v.empty()) return;
+    uint64_t cur = 0;
+    for(int i = 0; i < n; i++){
+      cur <<= 1;
+      while(cur && !(v[i - __builtin_ctzll(cur)] < v[i])) cur &= cur - 1;
+      mask[i] = (cur |= 1);
+    }
+    int m = n >> block_size_log;
+    std::vector<T> v2(m);
+    for(int i = 0; i < m; i++) v2[i] = query_short(i << block_size_log, (i + 1) << block_size_log);
+    if(m) st = sparse_table<T, min_func, id>(v2);
+  }
+  T query(int l, int r){
+    l = std::max(l, 0);
+    r = std::min(r, n);
+    if(l >= r) return id();
+    if(r - l <= block_size) return query_short(l, r);
+    int lb = (l + block_size - 1) >> block_size_log, rb = r >> block_size_log;
+    T ret = st.query(lb, rb);
+    if(l < (lb << block_size_log)) ret = min_func(ret, query_short(l, lb << block_size_log));
+    if((rb << block_size_log) < r) ret = min_func(ret, query_short(rb << block_size_log, r));
+    return ret;
+  }
+  // query(l, r)で触る両端のマスクを読み込んでおく
+  void prefetch(int l, int r)const{
+    if(l >= r) return;
+    __builtin_prefetch(&mask[r - 1]);
+    __builtin_prefetch(&mask[std::min(r, l + block_size) - 1]);
+  }
+};
 #endif
@@ -0,0 +1,84 @@
+#ifndef _CONCURRENT_UNION_FIND_H_
+#define _CONCURRENT_UNION_FIND_H_
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <cstdint>
+#include "../../misc/random_number.hpp"
+
+// 複数スレッドから同時に呼べるunion_find (lock-free)
+// 根同士をランダムな優先度の低い方 -> 高い方へCASで繋ぐ, findはpath splitting
+// 並行に呼ばれた場合でも各操作は線形化可能
+struct concurrent_union_find{
+private:
+  int N;
+  uint64_t seed;
+  std::vector<std::atomic<int>> par;
+  std::atomic<int> cc;
+  // 頂点ごとの優先度, (優先度, 番号)で全順序にする
+  bool less_priority(int u, int v)const{
+    uint64_t a = mix(u), b = mix(v);
+    return a != b ? a < b : u < v;
+  }
+  uint64_t mix(uint64_t x)const{
+    x += seed;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+public:
+  concurrent_union_find(int n): N(n), seed(random_once()), par(n), cc(n){
+    for(int i = 0; i < n; i++) par[i].store(i, std::memory_order_relaxed);
+  }
+  int find(int u){
+    while(true){
+      int p = par[u].load(std::memory_order_acquire);
+      if(p == u) return u;
+      int gp = par[p].load(std::memory_order_acquire);
+      if(p != gp) par[u].compare_exchange_weak(p, gp, std::memory_order_release, std::memory_order_relaxed);
+      u = p;
+    }
+  }
+  bool same(int u, int v){
+    while(true){
+      u = find(u), v = find(v);
+      if(u == v) return true;
+      // uがまだ根ならこの時点で別の連結成分
+      if(par[u].load(std::memory_order_acquire) == u) return false;
+    }
+  }
+  bool unite(int u, int v){
+    while(true){
+      u = find(u), v = find(v);
+      if(u == v) return false;
+      if(less_priority(v, u)) std::swap(u, v);
+      int expected = u;
+      if(par[u].compare_exchange_strong(expected, v, std::memory_order_acq_rel, std::memory_order_relaxed)){
+        cc.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+  }
+  // 連結成分の数
+  int count_cc(){
+    return cc.load(std::memory_order_relaxed);
+  }
+  // 辺をthreads個のスレッドに分けてuniteする, 連結成分が減った数を返す
+  int unite_batch(const std::vector<std::pair<int, int>> &E, int threads = std::thread::hardware_concurrency()){
+    int M = E.size();
+    threads = std::max(1, std::min(threads, M / 4096));
+    std::atomic<int> merged(0);
+    auto work = [&](int id){
+      int l = (long long)M * id / threads, r = (long long)M * (id + 1) / threads, cnt = 0;
+      for(int i = l; i < r; i++) cnt += unite(E[i].first, E[i].second);
+      merged.fetch_add(cnt, std::memory_order_relaxed);
+    };
+    std::vector<std::thread> th;
+    for(int i = 1; i < threads; i++) th.emplace_back(work, i);
+    work(0);
+    for(auto &t : th) t.join();
+    return merged.load();
+  }
+};
+#endif
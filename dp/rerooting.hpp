@@ -18,28 +18,51 @@ struct rerooting{
   // sum[i] := iの頂点属性と子部分木の値をマージした値
   std::vector<Val> sum;
 
+  // 再帰を使わない(bfs順に処理する)
   void build(Tree &g, const std::vector<Val> &v){
-    auto dfs_up = [&](auto &&dfs_up, int cur, int par)->Val{
+    int root = 0;
+    int n = g.size();
+    sum_left.resize(n);
+    sum_right.resize(n);
+    std::vector<int> order(n), par(n);
+    // up[i] := iの部分木の値
+    std::vector<Val> up(n);
+    {
+      int l = 0, r = 0;
+      order[r++] = root;
+      par[root] = -1;
+      while(l < r){
+        int cur = order[l++];
+        for(auto &e : g[cur]){
+          if(e.t == par[cur]) continue;
+          par[e.t] = cur;
+          order[r++] = e.t;
+        }
+      }
+    }
+    for(int j = n - 1; j >= 0; j--){
+      int cur = order[j];
       int s = g[cur].size();
       sum_left[cur].resize(s, rerooting_structure::template id<Val>());
       Val res = rerooting_structure::template id<Val>();
       int par_idx = -1;
       for(int i = 0; i < s; i++){
-        if(g[cur][i].t == par){
+        if(g[cur][i].t == par[cur]){
           par_idx = i;
           sum_left[cur][i] = rerooting_structure::template id<Val>();
-        }else sum_left[cur][i] = rerooting_structure::template merge_up<edge, Val>(g[cur][i], dfs_up(dfs_up, g[cur][i].t, cur));
+        }else sum_left[cur][i] = rerooting_structure::template merge_up<edge, Val>(g[cur][i], up[g[cur][i].t]);
         res = rerooting_structure::template merge_sibling<Val>(res, sum_left[cur][i]);
       }
-      assert(par == -1 || par_idx != -1);
+      assert(par[cur] == -1 || par_idx != -1);
       // 親への辺を末尾にする
       if(par_idx != -1){
         std::swap(sum_left[cur][par_idx], sum_left[cur][s - 1]);
         std::swap(g[cur][par_idx], g[cur][s - 1]);
       }
-      return rerooting_structure::template merge_parent<Val>(v[cur], res);
-    };
-    auto dfs_down = [&](auto &&dfs_down, int cur, int par)->void{
+      up[cur] = rerooting_structure::template merge_parent<Val>(v[cur], res);
+    }
+    for(int j = 0; j < n; j++){
+      int cur = order[j];
       int s = g[cur].size();
       sum_right[cur].resize(s, rerooting_structure::template id<Val>());
       for(int i = 0; i < s; i++){
@@ -49,20 +72,13 @@ struct rerooting{
       for(int i = 1; i < s; i++) sum_left[cur][i] = rerooting_structure::template merge_sibling<Val>(sum_left[cur][i], sum_left[cur][i - 1]);
 
       for(int i = 0; i < s; i++){
-        if(g[cur][i].t == par) continue;
+        if(g[cur][i].t == par[cur]) continue;
         Val left = (!i ? rerooting_structure::template id<Val>() : sum_left[cur][i - 1]);
         Val right = (i == s - 1 ? rerooting_structure::template id<Val>() : sum_right[cur][s - i - 2]);
         Val mid = rerooting_structure::template merge_parent<Val>(v[cur], rerooting_structure::template merge_sibling<Val>(left, right));
         sum_left[g[cur][i].t].back() = rerooting_structure::template merge_up<edge, Val>(g[cur][i], mid);
-        dfs_down(dfs_down, g[cur][i].t, cur);
       }
-    };
-    int root = 0;
-    int n = g.size();
-    sum_left.resize(n);
-    sum_right.resize(n);
-    dfs_up(dfs_up, root, -1);
-    dfs_down(dfs_down, root, -1);
+    }
     sum = v;
     for(int i = 0; i < n; i++){
       if(!sum_left[i].empty()){
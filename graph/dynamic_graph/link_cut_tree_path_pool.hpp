@@ -0,0 +1,263 @@
+#ifndef _LINK_CUT_TREE_PATH_POOL_H_
+#define _LINK_CUT_TREE_PATH_POOL_H_
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <cassert>
+#include <cstdint>
+#include "../../algebraic_structure/monoid.hpp"
+
+// link_cut_tree_pathの頂点数固定版
+// ノードを配列に確保し, 子/親を32bitの添字で持つ(SoA)
+// 頂点番号 v (0 <= v < n) は内部で v + 1, 0番は空ノード(sz = 0, sum = id)
+template<typename monoid>
+struct link_cut_tree_path_pool{
+  using Val = typename monoid::Val;
+  using Lazy = typename monoid::Lazy;
+  static constexpr auto id = monoid::id;
+  static constexpr auto id_lazy = monoid::id_lazy;
+  static constexpr auto merge = monoid::merge;
+  static constexpr auto flip_val = monoid::flip;
+  static constexpr auto apply = monoid::apply;
+  static constexpr auto propagate_lazy = monoid::propagate;
+private:
+  int n;
+  std::vector<uint32_t> l, r, p, sz;
+  std::vector<uint8_t> rev;
+  std::vector<Val> val, sum;
+  std::vector<Lazy> lazy;
+
+  bool is_root(uint32_t v)const{
+    uint32_t q = p[v];
+    return !q || (l[q] != v && r[q] != v);
+  }
+  void update(uint32_t v){
+    sz[v] = sz[l[v]] + 1 + sz[r[v]];
+    Val s = val[v];
+    if(l[v]) s = merge(sum[l[v]], s);
+    if(r[v]) s = merge(s, sum[r[v]]);
+    sum[v] = s;
+  }
+  void propagate(uint32_t v, const Lazy &x){
+    lazy[v] = propagate_lazy(lazy[v], x);
+    val[v] = apply(val[v], x, 0, 1);
+    sum[v] = apply(sum[v], x, 0, sz[v]);
+  }
+  void flip(uint32_t v){
+    std::swap(l[v], r[v]);
+    sum[v] = flip_val(sum[v]);
+    rev[v] ^= 1;
+  }
+  void push_down(uint32_t v){
+    if(lazy[v] != id_lazy()){
+      if(l[v]) propagate(l[v], lazy[v]);
+      if(r[v]) propagate(r[v], lazy[v]);
+      lazy[v] = id_lazy();
+    }
+    if(rev[v]){
+      if(l[v]) flip(l[v]);
+      if(r[v]) flip(r[v]);
+      rev[v] = 0;
+    }
+  }
+  void rotate(uint32_t v){
+    uint32_t q = p[v], pp = p[q];
+    if(l[q] == v){
+      if((l[q] = r[v])) p[r[v]] = q;
+      r[v] = q;
+    }else{
+      if((r[q] = l[v])) p[l[v]] = q;
+      l[v] = q;
+    }
+    p[q] = v;
+    update(q), update(v);
+    if((p[v] = pp)){
+      if(l[pp] == q) l[pp] = v;
+      if(r[pp] == q) r[pp] = v;
+      update(pp);
+    }
+  }
+  void splay(uint32_t v){
+    push_down(v);
+    while(!is_root(v)){
+      uint32_t q = p[v];
+      if(is_root(q)){
+        push_down(q), push_down(v);
+        rotate(v);
+      }else{
+        uint32_t pp = p[q];
+        push_down(pp), push_down(q), push_down(v);
+        if((l[pp] == q) == (l[q] == v)) rotate(q);
+        else rotate(v);
+        rotate(v);
+      }
+    }
+  }
+  uint32_t expose(uint32_t v){
+    uint32_t c = 0;
+    for(uint32_t u = v; u; u = p[u]){
+      splay(u);
+      r[u] = c;
+      update(u);
+      c = u;
+    }
+    splay(v);
+    return c;
+  }
+  void evert(uint32_t v){
+    expose(v);
+    flip(v);
+    push_down(v);
+  }
+  uint32_t root(uint32_t v){
+    expose(v);
+    while(l[v]){
+      push_down(v);
+      v = l[v];
+    }
+    splay(v);
+    return v;
+  }
+  void cut_parent(uint32_t c){
+    expose(c);
+    uint32_t q = l[c];
+    if(!q) return;
+    l[c] = p[q] = 0;
+    update(c);
+  }
+public:
+  link_cut_tree_path_pool(): n(0){}
+  link_cut_tree_path_pool(int n): link_cut_tree_path_pool(std::vector<Val>(n, id())){}
+  link_cut_tree_path_pool(const std::vector<Val> &v): n(v.size()), l(n + 1, 0), r(n + 1, 0), p(n + 1, 0), sz(n + 1, 1),
+  rev(n + 1, 0), val(n + 1), sum(n + 1), lazy(n + 1, id_lazy()){
+    sz[0] = 0;
+    val[0] = sum[0] = id();
+    std::copy(v.begin(), v.end(), val.begin() + 1);
+    std::copy(v.begin(), v.end(), sum.begin() + 1);
+  }
+  int size()const{
+    return n;
+  }
+  // vを根にする
+  void evert(int v){
+    evert(uint32_t(v + 1));
+  }
+  int get_root(int v){
+    return int(root(v + 1)) - 1;
+  }
+  bool is_same(int u, int v){
+    return root(u + 1) == root(v + 1);
+  }
+  // 0-indexed
+  int depth(int v){
+    expose(v + 1);
+    return sz[v + 1] - 1;
+  }
+  // 非連結な場合 -1
+  int lca(int u, int v){
+    if(!is_same(u, v)) return -1;
+    expose(u + 1);
+    return int(expose(v + 1)) - 1;
+  }
+  // 非連結な場合 -1
+  int dist(int u, int v){
+    int w = lca(u, v);
+    if(w == -1) return -1;
+    return depth(u) + depth(v) - 2 * depth(w);
+  }
+  // 親, vが根の場合-1
+  int get_parent(int v){
+    uint32_t x = v + 1;
+    expose(x);
+    if(!l[x]) return -1;
+    push_down(x);
+    x = l[x];
+    while(r[x]){
+      push_down(x);
+      x = r[x];
+    }
+    splay(x);
+    return int(x) - 1;
+  }
+  // false: 辺を繋げなかった
+  // cを根にしてからexpose(par)し, 同じ木ならcがparのパスに入る(cの親が0でなくなる)ことで判定する
+  bool link(int par, int c){
+    uint32_t x = par + 1, y = c + 1;
+    evert(y);
+    expose(x);
+    if(x == y || p[y]) return false;
+    p[y] = x;
+    r[x] = y;
+    update(x);
+    return true;
+  }
+  // cの親との辺を切る
+  void cut_from_parent(int c){
+    cut_parent(c + 1);
+  }
+  // 辺(u, v)を切る, false: 辺が無かった
+  // uを根にしてexpose(v)するとvのパスはu...vになるので, 辺があるのはそれがu, vの2頂点の時
+  bool cut(int u, int v){
+    uint32_t x = u + 1, y = v + 1;
+    evert(x);
+    expose(y);
+    if(l[y] != x || sz[y] != 2) return false;
+    l[y] = p[x] = 0;
+    update(y);
+    return true;
+  }
+  void set(int v, Val x){
+    expose(v + 1);
+    val[v + 1] = x;
+    update(v + 1);
+  }
+  Val get(int v){
+    expose(v + 1);
+    return val[v + 1];
+  }
+  // 根からvまで更新
+  void update_path(int v, Lazy x){
+    expose(v + 1);
+    propagate(v + 1, x);
+    push_down(v + 1);
+  }
+  // u-vパスを更新(uを根にする)
+  void update_path(int u, int v, Lazy x){
+    evert(uint32_t(u + 1));
+    update_path(v, x);
+  }
+  // merge(val[root]...val[v])
+  Val query_path(int v){
+    expose(v + 1);
+    return sum[v + 1];
+  }
+  // merge(val[u]...val[v]), uを根にする
+  Val query_path(int u, int v){
+    evert(uint32_t(u + 1));
+    return query_path(v);
+  }
+
+  // merge(val[u]...val[v])をまとめて求める, 非連結な場合はid()
+  // 始点uが同じクエリをまとめてeverを1回にする
+  // link, cutのまとめた版は無い(linkは順番で繋がる辺が変わるので並び替えられず, cutは並び替えのコストの方が大きかった)
+  std::vector<Val> path_query_many(const std::vector<std::pair<int, int>> &Q){
+    int q = Q.size();
+    std::vector<int> ord(q);
+    std::iota(ord.begin(), ord.end(), 0);
+    std::sort(ord.begin(), ord.end(), [&](int a, int b){ return Q[a].first < Q[b].first; });
+    std::vector<Val> res(q, id());
+    int last = -1;
+    for(int j = 0; j < q; j++){
+      auto [u, v] = Q[ord[j]];
+      if(u != last){
+        evert(uint32_t(u + 1));
+        last = u;
+      }
+      if(j + 1 < q) __builtin_prefetch(&p[Q[ord[j + 1]].second + 1]);
+      if(root(v + 1) != uint32_t(u + 1)) continue;
+      res[ord[j]] = query_path(v);
+    }
+    return res;
+  }
+};
+#endif
@@ -1,82 +1,133 @@
 #ifndef _OFFLINE_DYNAMIC_CONNECTIVITY_H_
 #define _OFFLINE_DYNAMIC_CONNECTIVITY_H_
 #include <vector>
-#include <unordered_map>
 #include <cassert>
-#include <functional>
 #include <algorithm>
+#include <array>
 #include "../../data_structure/persistent/rollback_union_find.hpp"
 
-// UF := コンストラクタuf(N), 関数unite(a, b), rollback(a, bを持つ
-// F: (uf, query_id) -> void
-template<typename UF, typename F = std::function<void(UF&, int)>>
+// UF := コンストラクタuf(N), 関数unite(a, b), rollback()を持つ
+// (rollback_union_find, union_find_abelian_rollbackなど)
+// 辺の追加/削除はイベント列として記録しておき, solveの時に辺ごとにソートして生存区間を求める
+// 各生存区間をクエリ列上のセグメント木のO(logQ)個のノードに振り分け, 非再帰で走査する
+template<typename UF>
 struct offline_dynamic_connectivity{
 public:
   UF uf;
 private:
-  static constexpr int inf_time = 1 << 30;
+  static constexpr int LINK = 0, LINK_UNIQUE = 1, CUT = 2;
   int n;
-  std::unordered_multimap<long long, int> E; // {a, b, inesrt_time}
-  std::vector<std::pair<int, F>> Q;
-  struct Update{int a, b, link_time, cut_time;};
-  std::vector<Update> U{Update{0, 0, 0, 0}};
-
-  void solve(int l, int r, int &j, int &k){
-    assert(l != r);
-    if(r - l == 1){
-      while(k < Q.size() && Q[k].first == l) Q[k++].second(uf, j++);
-      return;
-    }
-    int mid = (l + r) / 2;
-    int cnt = 0;
-    for(int i = mid; i < r; i++) if(U[i].link_time <= l) cnt++, uf.unite(U[i].a, U[i].b);
-    solve(l, mid, j, k);
-    while(cnt) cnt--, uf.rollback();
-    for(int i = l; i <= mid; i++) if(r <= U[i].cut_time) cnt++, uf.unite(U[i].a, U[i].b);
-    solve(mid, r, j, k);
-    while(cnt) cnt--, uf.rollback();
+  struct Event{
+    long long key;
+    int time, type;
+  };
+  std::vector<Event> E;
+  std::vector<int> Q; // クエリ時点でのイベント数
+  static long long encode(int a, int b){
+    return ((long long)a << 32) + b;
   }
 public:
-  offline_dynamic_connectivity(int n): uf(n), n(n), E(n){}
+  offline_dynamic_connectivity(int n): uf(n), n(n){}
 
   // 辺a-bを追加する, すでにある場合は多重辺が追加される
   void link(int a, int b){
     if(a > b) std::swap(a, b);
     if(a == b) return;
-    int link_time = U.size();
-    E.emplace(((long long)a << 30) + b, link_time);
-    U.push_back(Update{a, b, link_time, inf_time});
+    E.push_back(Event{encode(a, b), (int)E.size(), LINK});
   }
   // 辺a-bを追加する, すでにある場合は何もしない
   void link_unique(int a, int b){
     if(a > b) std::swap(a, b);
     if(a == b) return;
-    auto itr = E.find(((long long)a << 30) + b);
-    if(itr != E.end()) return;
-    int link_time = U.size();
-    E.emplace(((long long)a << 30) + b, link_time);
-    U.push_back(Update{a, b, link_time, inf_time});
+    E.push_back(Event{encode(a, b), (int)E.size(), LINK_UNIQUE});
   }
   // 辺a-bを消す, ない場合は何もしない
   void cut(int a, int b){
     if(a > b) std::swap(a, b);
     if(a == b) return;
-    auto itr = E.find(((long long)a << 30) + b);
-    if(itr != E.end()){
-      int link_time = itr->second;
-      int cut_time = U.size();
-      U[link_time].cut_time = cut_time;
-      U.push_back({a, b, link_time, cut_time});
-      E.erase(itr);
-    }
+    E.push_back(Event{encode(a, b), (int)E.size(), CUT});
   }
-  void query(F f){
-    int query_time = (int)U.size() - 1;
-    Q.push_back(std::make_pair(query_time, f));
+  // クエリ番号を返す
+  int query(){
+    Q.push_back(E.size());
+    return (int)Q.size() - 1;
   }
-  void solve(){
-    int j = 0, k = 0;
-    solve(0, U.size(), j, k);
+  // f(uf, クエリ番号)がクエリ番号順に呼ばれる
+  template<typename F>
+  void solve(F f){
+    int q = Q.size();
+    if(q == 0) return;
+    int size = 1;
+    while(size < q) size <<= 1;
+    // 時刻tのイベント以降に生存している最初のクエリ
+    auto first_query = [&](int t){
+      return int(std::upper_bound(Q.begin(), Q.end(), t) - Q.begin());
+    };
+    // 辺ごとに生存区間[l, r)(クエリ番号)を求める
+    std::vector<std::array<int, 4>> I; // a, b, l, r
+    {
+      std::sort(E.begin(), E.end(), [](const Event &x, const Event &y){
+        return x.key != y.key ? x.key < y.key : x.time < y.time;
+      });
+      std::vector<int> alive;
+      int m = E.size();
+      for(int i = 0; i < m; ){
+        int j = i;
+        alive.clear();
+        int a = E[i].key >> 32, b = E[i].key & 0xFFFFFFFF;
+        for(; j < m && E[j].key == E[i].key; j++){
+          if(E[j].type == CUT){
+            if(alive.empty()) continue;
+            int l = first_query(alive.back()), r = first_query(E[j].time);
+            alive.pop_back();
+            if(l < r) I.push_back({a, b, l, r});
+          }else if(E[j].type == LINK || alive.empty()){
+            alive.push_back(E[j].time);
+          }
+        }
+        for(int t : alive){
+          int l = first_query(t);
+          if(l < q) I.push_back({a, b, l, q});
+        }
+        i = j;
+      }
+    }
+    // セグメント木のノードに振り分ける(CSR)
+    std::vector<int> start(2 * size + 1, 0);
+    auto for_each_node = [&](int l, int r, auto g){
+      for(l += size, r += size; l < r; l >>= 1, r >>= 1){
+        if(l & 1) g(l++);
+        if(r & 1) g(--r);
+      }
+    };
+    for(auto &x : I) for_each_node(x[2], x[3], [&](int k){ start[k + 1]++; });
+    for(int i = 0; i < 2 * size; i++) start[i + 1] += start[i];
+    std::vector<std::pair<int, int>> edges(start.back());
+    {
+      std::vector<int> pos(start.begin(), start.end() - 1);
+      for(auto &x : I) for_each_node(x[2], x[3], [&](int k){ edges[pos[k]++] = {x[0], x[1]}; });
+    }
+    std::vector<std::array<int, 4>>().swap(I);
+    // 非再帰で走査
+    int k = 1;
+    while(true){
+      for(int i = start[k]; i < start[k + 1]; i++) uf.unite(edges[i].first, edges[i].second);
+      if(k < size){
+        k <<= 1;
+        continue;
+      }
+      if(k - size < q) f(uf, k - size);
+      while(true){
+        for(int i = start[k]; i < start[k + 1]; i++) uf.rollback();
+        if(k == 1) return;
+        if(k & 1){
+          k >>= 1;
+        }else{
+          k++;
+          break;
+        }
+      }
+    }
   }
 };
 #endif
@@ -5,42 +5,84 @@
 #include <iostream>
 #include <cassert>
 
-#include <unordered_set>
-
 namespace online_dynamic_connectivity_internal{
+  // 各レベル, 各頂点の非木辺を侵入型の双方向リストで持つ
+  // 辺は半辺2本(e, e ^ 1)としてプールに確保し, 消した辺の番号は再利用する
+  // to[e]: 行き先, 半辺eはレベルlvの頂点to[e ^ 1]のリストに入っている
   struct surplus_edge{
     int N, maxlv;
-    std::vector<std::vector<std::unordered_multiset<int>>> E;
+    std::vector<int> head; // head[lv * N + v]
+    std::vector<int> deg;  // 全レベルでの次数
+    std::vector<int> to, nxt, prv;
+    int free_edge;
     surplus_edge(){}
-    surplus_edge(int N): N(N), maxlv(1), E(1, std::vector<std::unordered_multiset<int>>(N)){}
+    surplus_edge(int N): N(N), maxlv(1), head(N, -1), deg(N, 0), free_edge(-1){}
     void make_new_level(){
       maxlv++;
-      E.push_back(std::vector<std::unordered_multiset<int>>(N));
+      head.resize((long long)maxlv * N, -1);
+    }
+    void push_front(int lv, int v, int e){
+      int &h = head[(long long)lv * N + v];
+      prv[e] = -1;
+      nxt[e] = h;
+      if(h != -1) prv[h] = e;
+      h = e;
+    }
+    void unlink(int lv, int v, int e){
+      if(prv[e] == -1) head[(long long)lv * N + v] = nxt[e];
+      else nxt[prv[e]] = nxt[e];
+      if(nxt[e] != -1) prv[nxt[e]] = prv[e];
+    }
+    // e, e ^ 1を消す(eはレベルlvの頂点sのリストにある)
+    void erase_edge(int lv, int s, int e){
+      int t = to[e];
+      unlink(lv, s, e);
+      unlink(lv, t, e ^ 1);
+      deg[s]--, deg[t]--;
+      e &= ~1;
+      nxt[e] = free_edge;
+      free_edge = e;
     }
     void insert(int lv, int s, int t){
-      E[lv][s].insert(t);
-      E[lv][t].insert(s);
-    }
-    bool erase(int lv, int s, int t){
-      auto itr = E[lv][s].find(t);
-      if(itr == E[lv][s].end()) return false;
-      E[lv][s].erase(itr);
-      E[lv][t].erase(E[lv][t].find(s));
-      return true;
+      int e;
+      if(free_edge != -1){
+        e = free_edge;
+        free_edge = nxt[e];
+      }else{
+        e = to.size();
+        to.resize(e + 2);
+        nxt.resize(e + 2);
+        prv.resize(e + 2);
+      }
+      to[e] = t, to[e ^ 1] = s;
+      push_front(lv, s, e);
+      push_front(lv, t, e ^ 1);
+      deg[s]++, deg[t]++;
+    }
+    // 辺(s, t)をどれか1本消してそのレベルを返す, 無い場合は-1
+    // 次数が小さい方の端点のリストを全レベル走査する O(maxlv + min(deg))
+    int erase(int s, int t){
+      if(deg[s] > deg[t]) std::swap(s, t);
+      if(deg[s] == 0) return -1;
+      for(int lv = 0; lv < maxlv; lv++){
+        for(int e = head[(long long)lv * N + s]; e != -1; e = nxt[e]){
+          if(to[e] == t){
+            erase_edge(lv, s, e);
+            return lv;
+          }
+        }
+      }
+      return -1;
     }
     int erase_any(int lv, int s){
-      auto itr = E[lv][s].begin();
-      int ret;
-      if(itr == E[lv][s].end()) ret = -1;
-      else{
-        ret = *itr;
-        E[lv][s].erase(itr);
-        E[lv][ret].erase(E[lv][ret].find(s));
-      }
+      int e = head[(long long)lv * N + s];
+      if(e == -1) return -1;
+      int ret = to[e];
+      erase_edge(lv, s, e);
       return ret;
     }
     bool empty(int lv, int s){
-      return E[lv][s].empty();
+      return head[(long long)lv * N + s] == -1;
     }
   };
   struct toptree{
@@ -49,20 +91,70 @@ namespace online_dynamic_connectivity_internal{
       int size, light_size;
       bool flip, is_x;
       int id;
-      std::unordered_set<int> t;
+      int t_head, t_deg; // このレベルの木辺のリスト
       node *heavy_x, *heavy_y, *light_x, *light_y;
       node(int id):
       l(nullptr), r(nullptr), p(nullptr), light_top(nullptr), l2(nullptr), r2(nullptr), p2(nullptr),
-      size(1), light_size(1), flip(false), is_x(false), id(id), heavy_x(nullptr), heavy_y(nullptr), light_x(nullptr), light_y(nullptr){}
+      size(1), light_size(1), flip(false), is_x(false), id(id), t_head(-1), t_deg(0), heavy_x(nullptr), heavy_y(nullptr), light_x(nullptr), light_y(nullptr){}
       bool is_root_heavy(){return !p || (p->l != this && p->r != this);}
       bool is_root_light(){return !p2 || (p2->l2 != this && p2->r2 != this);}
     };
-    node *make_node(int id){return new node(id);}
+    // レベルkの木辺を半辺2本(e, e ^ 1)として両端点のリストに入れる
+    // te_to[e]: 行き先, 半辺eはte_to[e ^ 1]のリストに入っている
+    std::vector<node*> te_to;
+    std::vector<int> te_nxt, te_prv;
+    int te_free = -1;
+    void t_push(node *v, int e){
+      te_prv[e] = -1;
+      te_nxt[e] = v->t_head;
+      if(v->t_head != -1) te_prv[v->t_head] = e;
+      v->t_head = e;
+      v->t_deg++;
+    }
+    void t_unlink(node *v, int e){
+      if(te_prv[e] == -1) v->t_head = te_nxt[e];
+      else te_nxt[te_prv[e]] = te_nxt[e];
+      if(te_nxt[e] != -1) te_prv[te_nxt[e]] = te_prv[e];
+      v->t_deg--;
+    }
+    void t_insert(node *a, node *b){
+      int e;
+      if(te_free != -1){
+        e = te_free;
+        te_free = te_nxt[e];
+      }else{
+        e = te_to.size();
+        te_to.resize(e + 2);
+        te_nxt.resize(e + 2);
+        te_prv.resize(e + 2);
+      }
+      te_to[e] = b, te_to[e ^ 1] = a;
+      t_push(a, e);
+      t_push(b, e ^ 1);
+    }
+    // 半辺eを含む辺を両端点のリストから消す
+    void t_erase(int e){
+      t_unlink(te_to[e ^ 1], e);
+      t_unlink(te_to[e], e ^ 1);
+      e &= ~1;
+      te_nxt[e] = te_free;
+      te_free = e;
+    }
+    // 辺(a, b)があれば消す, 次数が小さい方のリストを走査する
+    void t_erase(node *a, node *b){
+      if(a->t_deg > b->t_deg) std::swap(a, b);
+      for(int e = a->t_head; e != -1; e = te_nxt[e]){
+        if(te_to[e] == b){
+          t_erase(e);
+          return;
+        }
+      }
+    }
     toptree(){}
     void update_heavy(node *v){
       v->size = 1 + (v->l ? v->l->size : 0) + (v->r ? v->r->size : 0) + (v->light_top ? v->light_top->light_size : 0);
       v->heavy_x = v->is_x ? v : nullptr;
-      v->heavy_y = !v->t.empty() ? v : nullptr;
+      v->heavy_y = v->t_head != -1 ? v : nullptr;
       if(!v->heavy_x){
         if(v->l && v->l->heavy_x) v->heavy_x = v->l->heavy_x;
         else if(v->r && v->r->heavy_x) v->heavy_x = v->r->heavy_x;
@@ -272,11 +364,8 @@ namespace online_dynamic_connectivity_internal{
       c->p = p;
       p->r = c;
       if(is_k){
-        if(p->id < c->id) p->t.insert(c->id);
-        else{
-          c->t.insert(p->id);
-          update_heavy(c);
-        }
+        t_insert(p, c);
+        update_heavy(c);
       }
       update_heavy(p);
     }
@@ -307,12 +396,12 @@ namespace online_dynamic_connectivity_internal{
         splay_heavy(rm);
         return false;
       }
-      if(v->id < u->id) v->t.erase(u->id);
-      else u->t.erase(v->id);
+      t_erase(u, v);
       v->l->p = nullptr;
       v->l = nullptr;
       update_heavy(v);
       splay_heavy(u);
+      update_heavy(u);
       return true;
     }
     int size(node *v){
@@ -338,9 +427,21 @@ namespace online_dynamic_connectivity_internal{
       while(v->heavy_y){
         v = v->heavy_y;
         expose(v);
-        for(int t: v->t) ret.push_back({v->id, t});
-        v->t.clear();
+        std::vector<node*> other;
+        while(v->t_head != -1){
+          int e = v->t_head;
+          node *w = te_to[e];
+          ret.push_back({v->id, w->id});
+          other.push_back(w);
+          t_erase(e);
+        }
         update_heavy(v);
+        // 反対側の端点の集約値も更新する
+        for(node *w : other){
+          expose(w);
+          update_heavy(w);
+        }
+        expose(v);
       }
       return ret;
     }
@@ -354,10 +455,17 @@ private:
   int N, maxlv;
   online_dynamic_connectivity_internal::surplus_edge E;
   tt F;
-  std::vector<std::vector<node*>> ptr;
+  std::vector<std::vector<node>> nodes; // レベルごとに連続領域に確保する
+  node *ptr(int k, int i){
+    return &nodes[k][i];
+  }
+  void add_level_nodes(){
+    nodes.emplace_back();
+    nodes.back().reserve(N);
+    for(int i = 0; i < N; i++) nodes.back().emplace_back(i);
+  }
   void make_new_level(){
-    ptr.push_back(std::vector<node*>(N));
-    for(int i = 0; i < N; i++ ) ptr[maxlv][i] = F.make_node(i);
+    add_level_nodes();
     E.make_new_level();
     maxlv++;
   }
@@ -374,29 +482,29 @@ private:
   // a, bを連結にできるか判定
   bool replace(int a, int b, int k){
     if(k == -1) return false;
-    if(F.size(ptr[k][a]) > F.size(ptr[k][b])) std::swap(a, b);
-    node *A = ptr[k][a];
+    if(F.size(ptr(k, a)) > F.size(ptr(k, b))) std::swap(a, b);
+    node *A = ptr(k, a);
     auto e = F.enumerate_level_k_edge(A);
     for(auto [x, y] : e){
       if(k == maxlv - 1) make_new_level();
-      F._link(ptr[k + 1][x], ptr[k + 1][y], true);
+      F._link(ptr(k + 1, x), ptr(k + 1, y), true);
     }
     F.expose(A);
     while(A->heavy_x){
       A = A->heavy_x;
       if(k == maxlv - 1) make_new_level();
-      node *A2 = ptr[k + 1][A->id];
+      node *A2 = ptr(k + 1, A->id);
       while(!E.empty(k, A->id)){
         int t = E.erase_any(k, A->id);
-        if(E.empty(k, t)) off(ptr[k][t]);
-        if(!F.is_same(A, ptr[k][t])){
+        if(E.empty(k, t)) off(ptr(k, t));
+        if(!F.is_same(A, ptr(k, t))){
           for(int i = 0; i <= k; i++){
-            F._link(ptr[i][A->id], ptr[i][t], i == k);
+            F._link(ptr(i, A->id), ptr(i, t), i == k);
           }
           return true;
         }
         if(E.empty(k + 1, A->id)) on(A2);
-        if(E.empty(k + 1, t)) on(ptr[k + 1][t]);
+        if(E.empty(k + 1, t)) on(ptr(k + 1, t));
         E.insert(k + 1, A->id, t);
       }
       off(A);
@@ -406,13 +514,13 @@ private:
 public:
   int num_cc;
 
-  online_dynamic_connectivity(int N): N(N), maxlv(1), E(N), ptr(1, std::vector<node*>(N)), num_cc(N){
-    for(int i = 0; i < N; i++) ptr[0][i] = F.make_node(i);
+  online_dynamic_connectivity(int N): N(N), maxlv(1), E(N), num_cc(N){
+    add_level_nodes();
   }
   // 辺(a, b)を追加する　, すでに辺(a, b)があっても追加する
   // 0: すでに連結だった, 1: 新たに連結になった
   bool link(int a, int b){
-    node *A = ptr[0][a], *B = ptr[0][b];
+    node *A = ptr(0, a), *B = ptr(0, b);
     if(F.is_same(A, B)){
       if(E.empty(0, a)) on(A);
       if(E.empty(0, b)) on(B);
@@ -426,21 +534,18 @@ public:
   }
   // 辺(a, b)を切る 辺が無かった: 0, 辺が橋だった: 1, まだ連結: 2
   int cut(int a, int b){
-    node *A = ptr[0][a], *B = ptr[0][b];
+    node *A = ptr(0, a), *B = ptr(0, b);
     if(!F.is_same(A, B)) return 0;
     if(!F.cut(A, B)){
-      for(int i = 0; i < maxlv; i++){
-        if(E.erase(i, a, b)){
-          if(E.empty(i, a)) off(ptr[i][a]);
-          if(E.empty(i, b)) off(ptr[i][b]);
-          return 2;
-        }
-      }
-      return 0;
+      int i = E.erase(a, b);
+      if(i == -1) return 0;
+      if(E.empty(i, a)) off(ptr(i, a));
+      if(E.empty(i, b)) off(ptr(i, b));
+      return 2;
     }else{
       int k = 0;
       for(int i = 1; i < maxlv; i++){
-        if(F.cut(ptr[i][a], ptr[i][b])) k = i;
+        if(F.cut(ptr(i, a), ptr(i, b))) k = i;
         else break;
       }
       int ret = replace(a, b, k) ? 2 : 1;
@@ -450,11 +555,11 @@ public:
   }
   // aを含む連結成分のサイズ
   int size(int a){
-    return F.size(ptr[0][a]);
+    return F.size(ptr(0, a));
   }
   // a, bが連結か
   bool same(int a, int b){
-    return F.is_same(ptr[0][a], ptr[0][b]);
+    return F.is_same(ptr(0, a), ptr(0, b));
   }
   // 連結成分の数
   int connected_component(){
@@ -5,48 +5,49 @@
 #include <cassert>
 #include "../data_structure/range_query/sparse_table.hpp"
 
+// preorderでi番目の頂点の親のpreorderをpar_order[i]とすると
+// pre(u) < pre(v)のときlca(u, v) = pre_kth(min(par_order[pre(u) + 1, pre(v)]))
 struct fast_lca{
 private:
   using graph = std::vector<std::vector<int>>;
   int N;
-  std::vector<int> begin, end, begin_compressed, tour_compressed, dep, id2order, order2id;
-  rmq<int> table;
-  void init_dfs(int v, int p, const graph &g, int &a, int &b, int &c){
-    id2order[v] = b, order2id[b++] = v, begin[v] = end[v] = c++;
-    for(int t : g[v]){
-      if(t == p) continue;
+  std::vector<int> begin, end, dep, id2order, order2id;
+  rmq_linear<int> table;
+  // 非再帰dfs
+  template<typename G, typename F>
+  void init(const G &g, int root, F to){
+    std::vector<int> par_order(N, -1), par(N, -1), itr(N, 0), st;
+    st.reserve(N);
+    int b = 0, c = 0;
+    st.push_back(root);
+    dep[root] = 0;
+    id2order[root] = b, order2id[b++] = root, begin[root] = end[root] = c++;
+    while(!st.empty()){
+      int v = st.back();
+      if(itr[v] == (int)g[v].size()){
+        st.pop_back();
+        if(!st.empty()) end[st.back()] = c++;
+        continue;
+      }
+      int t = to(g[v][itr[v]++]);
+      if(t == par[v]) continue;
+      par[t] = v;
       dep[t] = dep[v] + 1;
-      init_dfs(t, v, g, a, b, c);
-      end[v] = c++;
-      tour_compressed.push_back(id2order[v]);
-      if(begin_compressed[v] == -1) begin_compressed[v] = a;
-      a++;
+      par_order[b] = id2order[v];
+      id2order[t] = b, order2id[b++] = t, begin[t] = end[t] = c++;
+      st.push_back(t);
     }
-    if(begin_compressed[v] == -1) begin_compressed[v] = a;
+    table = rmq_linear<int>(par_order);
   }
 public:
   fast_lca(){}
-  // init O(NlogN)
-  fast_lca(const graph &g, int root): N(g.size()), begin(N), end(N),
-  begin_compressed(N, -1), dep(N), id2order(N), order2id(N){
-    dep[root] = 0;
-    int a = 0, b = 0, c = 0;
-    init_dfs(root, -1, g, a, b, c);
-    table = rmq<int>(tour_compressed);
+  // init O(N)
+  fast_lca(const graph &g, int root): N(g.size()), begin(N), end(N), dep(N), id2order(N), order2id(N){
+    init(g, root, [](int t){ return t; });
   }
   template<typename edge>
-  fast_lca(const std::vector<std::vector<edge>> &g, int root): N(g.size()), begin(N), end(N), 
-  begin_compressed(N, -1), dep(N), id2order(N), order2id(N){
-    std::vector<std::vector<int>> g2(N);
-    for(int i = 0; i < N; i++){
-      for(auto &e : g[i]){
-        g2[i].push_back(e.t);
-      }
-    }
-    dep[root] = 0;
-    int a = 0, b = 0, c = 0;
-    init_dfs(root, -1, g2, a, b, c);
-    table = rmq<int>(tour_compressed);
+  fast_lca(const std::vector<std::vector<edge>> &g, int root): N(g.size()), begin(N), end(N), dep(N), id2order(N), order2id(N){
+    init(g, root, [](const edge &e){ return e.t; });
   }
   // preorderでvを訪れる順番
   inline int pre_order(int v)const{
@@ -73,9 +74,30 @@ public:
   }
   // O(1) per query
   inline int lca(int u, int v){
-    if(begin_compressed[u] == begin_compressed[v]) return (dep[u] > dep[v] ? v : u);
-    if(begin_compressed[u] > begin_compressed[v]) std::swap(u, v);
-    return order2id[table.query(begin_compressed[u], begin_compressed[v] + 1)];
+    if(u == v) return u;
+    int a = id2order[u], b = id2order[v];
+    if(a > b) std::swap(a, b);
+    return order2id[table.query(a + 1, b + 1)];
+  }
+  // 複数クエリをまとめて処理する
+  // 2段階でプリフェッチする(先のクエリのpreorder -> それを使ってrmqのテーブル)
+  std::vector<int> lca_many(const std::vector<std::pair<int, int>> &q){
+    static constexpr int dist_prefetch = 8;
+    int Q = q.size();
+    std::vector<int> res(Q);
+    for(int i = 0; i < Q; i++){
+      if(i + 2 * dist_prefetch < Q){
+        __builtin_prefetch(&id2order[q[i + 2 * dist_prefetch].first]);
+        __builtin_prefetch(&id2order[q[i + 2 * dist_prefetch].second]);
+      }
+      if(i + dist_prefetch < Q){
+        int a = id2order[q[i + dist_prefetch].first], b = id2order[q[i + dist_prefetch].second];
+        if(a > b) std::swap(a, b);
+        table.prefetch(a + 1, b + 1);
+      }
+      res[i] = lca(q[i].first, q[i].second);
+    }
+    return res;
   }
   inline int depth(int v)const{
     return dep[v];
@@ -84,4 +106,4 @@ public:
     return dep[u] + dep[v] - 2 * dep[lca(u, v)];
   }
 };
-#endif
\ No newline at end of file
+#endif
@@ -1,84 +1,218 @@
 #ifndef _BIPARTITE_MATCHING_H_
 #define _BIPARTITE_MATCHING_H_
-#include "max_flow.hpp"
+#include <vector>
+#include <cassert>
+#include <atomic>
+#include <thread>
+#include <algorithm>
 
+// 隣接リストはCSR(左->右, 右->左)で持つ
+// bfs: フロンティアが大きい層ではbottom-up(未訪問側から親を探す)に切り替える
+// dfs: 明示的なスタック, 頂点をatomicに確保することで複数スレッドが頂点素なパスを同時に探す
 struct HopcroftKarp {
-  std::vector<std::vector<int>> g;
-  std::vector<int> dist, match;
-  std::vector<bool> used, vv;
-  HopcroftKarp(int n, int m) : g(n), match(m, -1), used(n){}
+  int n, m;
+  std::vector<int> eu, ev;
+  std::vector<int> start, adj, rstart, radj;
+  std::vector<int> dist, match, match_l;
+  bool built;
+  HopcroftKarp(int n, int m) : n(n), m(m), match(m, -1), match_l(n, -1), built(true){}
   void add_edge(int u, int v) {
-    g[u].push_back(v);
+    eu.push_back(u);
+    ev.push_back(v);
+    built = false;
   }
-  void bfs() {
-    dist.assign(g.size(), -1);
-    simple_queue<int> que;
-    for(int i = 0; i < g.size(); i++) {
-      if(!used[i]) {
-        que.push(i);
+  // 以前のマッチングp(p[i] := 左側のiのペア, 無い場合は-1)から始める
+  // 現在のグラフに存在しない辺や重複するペアは無視する
+  void warm_start(const std::vector<int> &p){
+    assert((int)p.size() == n);
+    build();
+    std::fill(match.begin(), match.end(), -1);
+    std::fill(match_l.begin(), match_l.end(), -1);
+    for(int i = 0; i < n; i++){
+      int b = p[i];
+      assert(b == -1 || (0 <= b && b < m));
+      if(b < 0 || match[b] != -1) continue;
+      if(std::find(adj.begin() + start[i], adj.begin() + start[i + 1], b) == adj.begin() + start[i + 1]) continue;
+      match[b] = i;
+      match_l[i] = b;
+    }
+  }
+private:
+  void build(){
+    if(built) return;
+    int k = eu.size();
+    start.assign(n + 1, 0);
+    rstart.assign(m + 1, 0);
+    for(int i = 0; i < k; i++) start[eu[i] + 1]++, rstart[ev[i] + 1]++;
+    for(int i = 0; i < n; i++) start[i + 1] += start[i];
+    for(int i = 0; i < m; i++) rstart[i + 1] += rstart[i];
+    adj.resize(k);
+    radj.resize(k);
+    std::vector<int> p(start.begin(), start.end() - 1), q(rstart.begin(), rstart.end() - 1);
+    for(int i = 0; i < k; i++){
+      adj[p[eu[i]]++] = ev[i];
+      radj[q[ev[i]]++] = eu[i];
+    }
+    built = true;
+  }
+  // 空いている右頂点に到達できればtrue
+  bool bfs(){
+    dist.assign(n, -1);
+    std::vector<int> cur, nxt;
+    long long unvisited_edges = adj.size(), frontier_edges = 0;
+    for(int i = 0; i < n; i++){
+      if(match_l[i] == -1){
         dist[i] = 0;
+        cur.push_back(i);
+        frontier_edges += start[i + 1] - start[i];
+        unvisited_edges -= start[i + 1] - start[i];
       }
     }
-    while(!que.empty()) {
-      int a = que.front();
-      que.pop();
-      for(auto &b : g[a]){
-        int c = match[b];
-        if(c >= 0 && dist[c] == -1) {
-          dist[c] = dist[a] + 1;
-          que.push(c);
+    bool found = false, bottom_up = false;
+    for(int d = 0; !cur.empty(); d++){
+      nxt.clear();
+      if(!bottom_up) bottom_up = frontier_edges * 14 > unvisited_edges;
+      else bottom_up = (long long)cur.size() * 24 >= n;
+      if(bottom_up){
+        // bottom-up: 未訪問の左頂点cについて, 相方bに隣接する頂点が現在の層にあるか
+        for(int a : cur){
+          for(int i = start[a]; i < start[a + 1]; i++) found |= match[adj[i]] == -1;
+        }
+        for(int c = 0; c < n; c++){
+          if(dist[c] != -1) continue;
+          int b = match_l[c];
+          for(int i = rstart[b]; i < rstart[b + 1]; i++){
+            if(dist[radj[i]] == d){
+              dist[c] = d + 1;
+              nxt.push_back(c);
+              break;
+            }
+          }
+        }
+      }else{
+        for(int a : cur){
+          for(int i = start[a]; i < start[a + 1]; i++){
+            int c = match[adj[i]];
+            if(c == -1) found = true;
+            else if(dist[c] == -1){
+              dist[c] = d + 1;
+              nxt.push_back(c);
+            }
+          }
         }
       }
+      frontier_edges = 0;
+      for(int c : nxt) frontier_edges += start[c + 1] - start[c];
+      unvisited_edges -= frontier_edges;
+      std::swap(cur, nxt);
     }
+    return found;
   }
-  bool dfs(int a) {
-    vv[a] = true;
-    for(auto &b : g[a]) {
-      int c = match[b];
-      if(c < 0 || (!vv[c] && dist[c] == dist[a] + 1 && dfs(c))) {
-        match[b] = a;
-        used[a] = true;
-        return (true);
+  struct phase_state{
+    std::vector<std::atomic<char>> vl, vr;
+    std::vector<int> itr;
+    phase_state(int n, int m): vl(n), vr(m), itr(n){}
+  };
+  // rootから増加路を探して見つかれば流す
+  // 頂点はatomicに確保するため別スレッドの増加路と頂点素になる
+  bool dfs(int root, phase_state &st, std::vector<int> &stk){
+    if(st.vl[root].exchange(1)) return false;
+    stk.clear();
+    stk.push_back(root);
+    st.itr[root] = start[root];
+    while(!stk.empty()){
+      int a = stk.back();
+      int &i = st.itr[a];
+      bool pushed = false;
+      for(; i < start[a + 1]; i++){
+        int b = adj[i];
+        int c = __atomic_load_n(&match[b], __ATOMIC_RELAXED);
+        if(c == -1){
+          if(st.vr[b].exchange(1)) continue;
+          for(int a2 : stk){
+            int b2 = adj[st.itr[a2]];
+            __atomic_store_n(&match[b2], a2, __ATOMIC_RELAXED);
+            match_l[a2] = b2;
+          }
+          return true;
+        }
+        if(dist[c] == dist[a] + 1 && !st.vl[c].exchange(1)){
+          st.itr[c] = start[c];
+          stk.push_back(c);
+          pushed = true;
+          break;
+        }
       }
+      if(pushed) continue;
+      stk.pop_back();
+      if(!stk.empty()) st.itr[stk.back()]++;
     }
-    return (false);
+    return false;
   }
-  int bipartite_matching(){
-    int ret = 0;
-    while(true) {
-      bfs();
-      vv.assign(g.size(), false);
+  int phase(int threads){
+    phase_state st(n, m);
+    std::vector<int> roots;
+    for(int i = 0; i < n; i++) if(match_l[i] == -1) roots.push_back(i);
+    threads = std::max(1, std::min<int>(threads, roots.size() / 1024));
+    if(threads == 1){
+      std::vector<int> stk;
       int flow = 0;
-      for(int i = 0; i < g.size(); i++) {
-        if(!used[i] && dfs(i)) ++flow;
+      for(int r : roots) flow += dfs(r, st, stk);
+      return flow;
+    }
+    std::atomic<int> pos(0), flow(0);
+    auto work = [&](){
+      std::vector<int> stk;
+      int f = 0;
+      static constexpr int chunk = 256;
+      while(true){
+        int l = pos.fetch_add(chunk);
+        if(l >= (int)roots.size()) break;
+        int r = std::min<int>(l + chunk, roots.size());
+        for(int j = l; j < r; j++) f += dfs(roots[j], st, stk);
       }
-      if(flow == 0) return (ret);
-      ret += flow;
+      flow += f;
+    };
+    std::vector<std::thread> th;
+    for(int i = 0; i < threads - 1; i++) th.emplace_back(work);
+    work();
+    for(auto &t : th) t.join();
+    return flow;
+  }
+public:
+  // threads: dfsを行うスレッド数
+  // 返り値は現在のマッチングのサイズ
+  int bipartite_matching(int threads = 1){
+    build();
+    while(bfs()){
+      // 並列に探すと互いに頂点を取り合って全て失敗することがあるので, その場合は逐次で探す
+      if(phase(threads) == 0 && phase(1) == 0) break;
     }
+    return n - std::count(match_l.begin(), match_l.end(), -1);
   }
 };
 struct bipartite_matching{
-  int n, m, s, t, edgenum;
+  int n, m;
   HopcroftKarp g;
-  bipartite_matching(int n, int m): n(n), m(m), s(n + m), t(s + 1), edgenum(0), g(n, m){}
-  // 左側のiと右側のjに辺を張る　
+  bipartite_matching(int n, int m): n(n), m(m), g(n, m){}
+  // 左側のiと右側のjに辺を張る
   void add_edge(int i, int j){
     assert(0 <= i && i < n);
     assert(0 <= j && j < m);
     g.add_edge(i, j);
   }
+  // 以前のマッチング(flowの返り値のv)から始める
+  void warm_start(const std::vector<int> &p){
+    g.warm_start(p);
+  }
   // {最大流, v} v[i] := 左側のiに対する右側のペア　　存在しない場合は-1
-  std::pair<int, std::vector<int>> flow(){
-    int f = g.bipartite_matching();
-    std::vector<int> p(n, -1);
-    for(int i = 0; i < m; i++){
-      if(g.match[i] != -1) p[g.match[i]] = i;
-    }
-    return {f, g.match};
+  std::pair<int, std::vector<int>> flow(int threads = 1){
+    int f = g.bipartite_matching(threads);
+    return {f, g.match_l};
   }
   // {最大流, E}
-  std::pair<int, std::vector<std::pair<int, int>>> flow_edge(){
-    int f = g.bipartite_matching();
+  std::pair<int, std::vector<std::pair<int, int>>> flow_edge(int threads = 1){
+    int f = g.bipartite_matching(threads);
     std::vector<std::pair<int, int>> E;
     for(int i = 0; i < m; i++){
       if(g.match[i] != -1) E.push_back({g.match[i], i});
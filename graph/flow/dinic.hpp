@@ -2,63 +2,120 @@
 #define _DINIC_H_
 #include <vector>
 #include <cassert>
-#include <queue>
 #include <limits>
 #include <algorithm>
 
+// 辺i(順辺)は2i, 逆辺は2i+1 (e^1で対の辺)
+// 隣接リストはmax_flow時にCSRに詰め直す, dfsは明示的なスタックで行う
 template<typename T>
 struct Dinic{
   int n;
-  struct edge{
-    int to, rev;
-    T cap, initial;
-    edge(int to, int rev, T cap):to(to), rev(rev), cap(cap), initial(cap){}
-  };
-  std::vector<std::vector<edge>> G;
-  std::vector<int> level, itr;
-  Dinic(int n):n(n), G(n, vector<edge>()), level(n), itr(n){}
+  std::vector<int> to, from;
+  std::vector<T> cap, initial;
+  std::vector<int> start, adj;
+  std::vector<int> level, itr, que, path;
+  bool built;
+  Dinic(int n): n(n), start(n + 1, 0), level(n), itr(n), que(n), built(true){}
 
-  void add_edge(int from, int to, T cap){
-    G[from].push_back(edge(to, (int)G[to].size(), cap));
-    G[to].push_back(edge(from, (int)G[from].size()-1, 0));
+  // 辺番号を返す
+  int add_edge(int from_, int to_, T c){
+    assert(0 <= from_ && from_ < n && 0 <= to_ && to_ < n && 0 <= c);
+    int id = to.size() / 2;
+    to.push_back(to_), from.push_back(from_), cap.push_back(c), initial.push_back(c);
+    to.push_back(from_), from.push_back(to_), cap.push_back(0), initial.push_back(0);
+    built = false;
+    return id;
   }
-  void bfs(int s){
-    level.assign(n, -1);
-    std::queue<int> q;
+  // i番目の辺に流れている流量
+  T get_flow(int i){
+    return initial[2 * i] - cap[2 * i];
+  }
+private:
+  void build(){
+    if(built) return;
+    int m = to.size();
+    std::fill(start.begin(), start.end(), 0);
+    for(int e = 0; e < m; e++) start[from[e] + 1]++;
+    for(int i = 0; i < n; i++) start[i + 1] += start[i];
+    adj.resize(m);
+    std::vector<int> pos(start.begin(), start.end() - 1);
+    for(int e = 0; e < m; e++) adj[pos[from[e]]++] = e;
+    built = true;
+  }
+  bool bfs(int s, int t){
+    std::fill(level.begin(), level.end(), -1);
+    int l = 0, r = 0;
     level[s] = 0;
-    q.push(s);
-    while(!q.empty()){
-      int v = q.front();q.pop();
-      for(auto &e:G[v]){
-        if(e.cap > 0 && level[e.to] < 0){
-          level[e.to] = level[v] + 1;
-          q.push(e.to);
+    que[r++] = s;
+    while(l < r){
+      int v = que[l++];
+      int lv = level[v] + 1;
+      for(int i = start[v]; i < start[v + 1]; i++){
+        int e = adj[i], u = to[e];
+        if(cap[e] > 0 && level[u] < 0){
+          level[u] = lv;
+          if(u == t) return true;
+          que[r++] = u;
         }
       }
     }
+    return false;
   }
-  T dfs(int v, int t, T f){
-    if(v==t) return f;
-    for(int &i = itr[v];i<(int)G[v].size();i++){
-      edge &e = G[v][i];
-      if(e.cap>0&&level[v] < level[e.to]){
-        T d = dfs(e.to, t, min(f, e.cap));
-        if(d > 0){
-          e.cap -= d;
-          G[e.to][e.rev].cap += d;
-          return d;
+  // レベルグラフ上のブロッキングフロー
+  T blocking_flow(int s, int t, T limit){
+    T res = 0;
+    path.clear();
+    int v = s;
+    while(true){
+      if(v == t){
+        T f = limit - res;
+        for(int e : path) f = std::min(f, cap[e]);
+        int back = -1;
+        for(int i = 0; i < (int)path.size(); i++){
+          int e = path[i];
+          cap[e] -= f;
+          cap[e ^ 1] += f;
+          if(back == -1 && cap[e] == 0) back = i;
         }
+        res += f;
+        if(res == limit) break;
+        path.resize(back);
+        v = back == 0 ? s : to[path.back()];
+        continue;
+      }
+      int &i = itr[v];
+      int lv = level[v] + 1;
+      for(; i < start[v + 1]; i++){
+        int e = adj[i];
+        if(cap[e] > 0 && level[to[e]] == lv) break;
+      }
+      if(i < start[v + 1]){
+        path.push_back(adj[i]);
+        v = to[adj[i]];
+      }else{
+        level[v] = -1;
+        if(path.empty()) break;
+        path.pop_back();
+        v = path.empty() ? s : to[path.back()];
+        itr[v]++;
       }
     }
-    return 0;
+    return res;
+  }
+public:
+  T max_flow(int s, int t){
+    return max_flow(s, t, std::numeric_limits<T>::max());
   }
-  T max_flow(int s, int t) {
-    T ret = 0, f;
-    while(bfs(s), level[t] >= 0){
-      itr.assign(n,0);
-      while ((f = dfs(s, t, std::numeric_limits<T>::max())) > 0) ret += f;
+  // 流量がlimitに達したら打ち切る
+  T max_flow(int s, int t, T limit){
+    assert(s != t);
+    build();
+    T ret = 0;
+    while(ret < limit && bfs(s, t)){
+      std::copy(start.begin(), start.end() - 1, itr.begin());
+      ret += blocking_flow(s, t, limit - ret);
     }
     return ret;
   }
 };
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,218 @@
+#ifndef _GRAPH_ALGORITHM_PARALLEL_H_
+#define _GRAPH_ALGORITHM_PARALLEL_H_
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include "edge.hpp"
+#include "../misc/random_number.hpp"
+
+namespace graph_algorithm_parallel{
+  template<typename T>
+  using vec = std::vector<T>;
+
+  // threads - 1個のスレッドを作っておき, run(f)の度に使い回す
+  // run(f): f(id) (0 <= id < threads)を並列に呼んで全て終わるまで待つ, id = 0は呼び出したスレッド
+  struct worker_pool{
+    int threads;
+  private:
+    std::vector<std::thread> th;
+    std::mutex mtx;
+    std::condition_variable cv_start, cv_done;
+    const std::function<void(int)> *job = nullptr;
+    uint64_t gen = 0;
+    int running = 0;
+    bool stop = false;
+    void loop(int id){
+      uint64_t seen = 0;
+      while(true){
+        const std::function<void(int)> *f;
+        {
+          std::unique_lock<std::mutex> lk(mtx);
+          cv_start.wait(lk, [&]{ return stop || gen != seen; });
+          if(stop) return;
+          seen = gen;
+          f = job;
+        }
+        (*f)(id);
+        std::lock_guard<std::mutex> lk(mtx);
+        if(--running == 0) cv_done.notify_one();
+      }
+    }
+  public:
+    worker_pool(int threads): threads(std::max(1, threads)){
+      for(int i = 1; i < this->threads; i++) th.emplace_back([this, i]{ loop(i); });
+    }
+    worker_pool(const worker_pool&) = delete;
+    worker_pool &operator=(const worker_pool&) = delete;
+    ~worker_pool(){
+      {
+        std::lock_guard<std::mutex> lk(mtx);
+        stop = true;
+      }
+      cv_start.notify_all();
+      for(auto &t : th) t.join();
+    }
+    void run(const std::function<void(int)> &f){
+      if(threads == 1){
+        f(0);
+        return;
+      }
+      {
+        std::lock_guard<std::mutex> lk(mtx);
+        job = &f;
+        running = threads - 1;
+        gen++;
+      }
+      cv_start.notify_all();
+      f(0);
+      std::unique_lock<std::mutex> lk(mtx);
+      cv_done.wait(lk, [&]{ return running == 0; });
+    }
+  };
+
+  // [l, r)をpoolのスレッドに分けてf(i)を呼ぶ, 短い場合は呼び出したスレッドだけで処理する
+  template<typename F>
+  void parallel_for(int l, int r, worker_pool &pool, const F &f){
+    static constexpr int min_chunk = 1 << 14;
+    int threads = std::max(1, std::min(pool.threads, (r - l) / min_chunk));
+    if(threads == 1){
+      for(int i = l; i < r; i++) f(i);
+      return;
+    }
+    pool.run([&](int id){
+      if(id >= threads) return;
+      int a = l + (long long)(r - l) * id / threads, b = l + (long long)(r - l) * (id + 1) / threads;
+      for(int i = a; i < b; i++) f(i);
+    });
+  }
+
+  // 代表元を番号の小さい方にするunion-find風の森
+  // link: 根の番号が大きい方を小さい方へCASで繋ぐ(Shiloach-Vishkinのhooking)
+  // compress: 全頂点を根に直接繋ぐ
+  struct hooking_forest{
+    std::vector<std::atomic<int>> comp;
+    hooking_forest(int n): comp(n){
+      for(int i = 0; i < n; i++) comp[i].store(i, std::memory_order_relaxed);
+    }
+    int get(int v){
+      return comp[v].load(std::memory_order_relaxed);
+    }
+    // 別々の木だった場合true
+    bool link(int u, int v){
+      int p1 = get(u), p2 = get(v);
+      while(p1 != p2){
+        int high = std::max(p1, p2), low = std::min(p1, p2);
+        int p_high = get(high);
+        if(p_high == low) return false;
+        if(p_high == high && comp[high].compare_exchange_strong(p_high, low)) return true;
+        p1 = get(get(high));
+        p2 = get(low);
+      }
+      return false;
+    }
+    void compress(worker_pool &pool){
+      parallel_for(0, comp.size(), pool, [&](int v){
+        while(get(v) != get(get(v))) comp[v].store(get(get(v)), std::memory_order_relaxed);
+      });
+    }
+  };
+
+  // 連結成分分解(Afforest)
+  // 1. 辺の一部をサンプリングしてlinkする
+  // 2. 最も大きい成分cを推定し, 両端が既にcに含まれる辺を読み飛ばす
+  // res[v] := vを含む連結成分の最小の頂点番号 (union_findの代表元とは番号の付け方のみ異なる)
+  template<typename edge>
+  vec<int> connected_components(int n, vec<edge> &E, int threads = std::thread::hardware_concurrency()){
+    int m = E.size();
+    hooking_forest f(n);
+    worker_pool pool(threads);
+    // 1. サンプリング
+    static constexpr int sample_rounds = 2;
+    int step = std::max(1, m / std::max(1, sample_rounds * n));
+    uint64_t offset = random_number(0, step - 1);
+    int num_sample = (m - offset + step - 1) / step;
+    parallel_for(0, num_sample, pool, [&](int i){
+      edge &e = E[offset + (long long)i * step];
+      f.link(e.from(), e.to());
+    });
+    f.compress(pool);
+    // 2. 最も大きい成分
+    int c = -1;
+    if(n){
+      std::unordered_map<int, int> cnt;
+      int best = 0;
+      for(int i = 0; i < 1024; i++){
+        int x = f.get(random_number(0, n - 1));
+        if(++cnt[x] > best) best = cnt[x], c = x;
+      }
+    }
+    parallel_for(0, m, pool, [&](int i){
+      if(i % step == (int)offset) return;
+      int u = E[i].from(), v = E[i].to();
+      if(f.get(u) == c && f.get(v) == c) return;
+      f.link(u, v);
+    });
+    f.compress(pool);
+    vec<int> res(n);
+    for(int i = 0; i < n; i++) res[i] = f.get(i);
+    return res;
+  }
+
+  // 最小全域森(Boruvka)
+  // 各ラウンドで各成分から出る最小の辺を並列に求めて縮約し, 両端が同じ成分になった辺を取り除く
+  // 重みが等しい辺は添字で順序を付ける
+  template<typename edge>
+  vec<edge> minimum_spanning_forest(int n, vec<edge> &E, int threads = std::thread::hardware_concurrency()){
+    int m = E.size();
+    hooking_forest f(n);
+    worker_pool pool(threads);
+    std::vector<std::atomic<int>> best(n);
+    std::vector<std::atomic<char>> used(m);
+    vec<int> alive(m), next_alive;
+    std::iota(alive.begin(), alive.end(), 0);
+    auto lighter = [&](int a, int b){
+      auto wa = E[a].wei(), wb = E[b].wei();
+      return wa < wb || (!(wb < wa) && a < b);
+    };
+    auto update = [&](int c, int i){
+      int cur = best[c].load(std::memory_order_relaxed);
+      while(cur == -1 || lighter(i, cur)){
+        if(best[c].compare_exchange_weak(cur, i)) break;
+      }
+    };
+    vec<edge> res;
+    while(!alive.empty()){
+      int k = alive.size();
+      parallel_for(0, n, pool, [&](int v){ best[v].store(-1, std::memory_order_relaxed); });
+      parallel_for(0, k, pool, [&](int j){
+        int i = alive[j];
+        int cu = f.get(E[i].from()), cv = f.get(E[i].to());
+        if(cu == cv) return;
+        update(cu, i);
+        update(cv, i);
+      });
+      parallel_for(0, n, pool, [&](int v){
+        int i = best[v].load(std::memory_order_relaxed);
+        if(i == -1) return;
+        if(!used[i].exchange(1)) f.link(E[i].from(), E[i].to());
+      });
+      f.compress(pool);
+      next_alive.clear();
+      for(int j = 0; j < k; j++){
+        int i = alive[j];
+        if(f.get(E[i].from()) != f.get(E[i].to())) next_alive.push_back(i);
+      }
+      if(next_alive.size() == alive.size()) break;
+      std::swap(alive, next_alive);
+    }
+    for(int i = 0; i < m; i++) if(used[i].load()) res.push_back(E[i]);
+    return res;
+  }
+}
+#endif
@@ -9,71 +9,84 @@
 namespace tree_algorithm{
   template<typename T>
   using vec = std::vector<T>;
+  // rootからのbfs順をorderに書き込み, 親と深さを求める(order, parent, depthはサイズn)
+  template<typename edge>
+  void bfs_parent(const vec<vec<edge>> &g, int root, vec<int> &order, vec<int> &parent, vec<int> &depth){
+    int l = 0, r = 0;
+    order[r++] = root;
+    parent[root] = -1;
+    depth[root] = 0;
+    while(l < r){
+      int v = order[l++];
+      for(const edge &e : g[v]){
+        if(e.t == parent[v]) continue;
+        parent[e.t] = v;
+        depth[e.t] = depth[v] + 1;
+        order[r++] = e.t;
+      }
+    }
+  }
   // 部分木のサイズ, 深さ, 親
   template<typename edge>
   std::tuple<vec<int>, vec<int>, vec<int>> simple_dfs(const vec<vec<edge>> &g, int root){
     int n = g.size();
-    vec<int> sz(n, 1), de(n), pa(n);
-    auto simple_dfs_f = [&](auto simple_dfs_f, int cur, int par, int dep)->void{
-      pa[cur] = par;
-      de[cur] = dep;
-      for(edge &e : g[cur]){
-        if(e.t == par) continue;
-        simple_dfs_f(simple_dfs_f, e.t, cur, dep + 1);
-        sz[cur] += sz[e.t];
-      }
-    };
-    simple_dfs_f(simple_dfs_f, root, -1, 0);
+    vec<int> sz(n, 1), de(n), pa(n), order(n);
+    bfs_parent(g, root, order, pa, de);
+    for(int i = n - 1; i > 0; i--) sz[pa[order[i]]] += sz[order[i]];
     return {sz, de, pa};
   }
+  // 再帰を使わない(深い木でも動く)
+  // head_in, parent_in: in順に並べたheadのin, 親のin (パスをたどる時に連続したメモリを触る)
   template<typename edge>
   struct hld{
     vec<int> subsize, depth, parent, in, out, head, rev, heavy;
+    vec<int> head_in, parent_in;
     hld(vec<vec<edge>> &g, int root){
       build(g, root);
     }
-    void dfs_sz(int cur, int par, int dep, vec<vec<edge>> &g){
-      depth[cur] = dep;
-      parent[cur] = par;
-      subsize[cur] = 1;
-      for(int i = 0; i < g[cur].size(); i++){
-        edge &e = g[cur][i];
-        if(e.t == par) continue;
-        dfs_sz(e.t, cur, dep + 1, g);
-        subsize[cur] += subsize[e.t];
-        if(heavy[cur] == -1 || subsize[g[cur][heavy[cur]].t] < subsize[e.t]){
-          heavy[cur] = i;
-        }
-      }
-    }
-    void dfs_hld(int cur, int par, int &times, vec<vec<edge>> &g){
-      in[cur] = times++;
-      rev[in[cur]] = cur;
-      int h = heavy[cur];
-      if(h != -1){
-        head[g[cur][h].t] = head[cur];
-        dfs_hld(g[cur][h].t, cur, times, g);
-      }
-      for(int i = 0; i < h; i++){
-        if(g[cur][i].t == par) continue;
-        head[g[cur][i].t] = g[cur][i].t;
-        dfs_hld(g[cur][i].t, cur, times, g);
-      }
-      for(int i = h + 1; i < g[cur].size(); i++){
-        if(g[cur][i].t == par) continue;
-        head[g[cur][i].t] = g[cur][i].t;
-        dfs_hld(g[cur][i].t, cur, times, g);
-      }
-      out[cur] = times;
-    }
     void build(vec<vec<edge>> &g, int root){
       int n = g.size();
-      subsize.resize(n), depth.resize(n), parent.resize(n);
+      subsize.resize(n, 1), depth.resize(n), parent.resize(n);
       in.resize(n), out.resize(n), head.resize(n), rev.resize(n), heavy.resize(n, -1);
-      dfs_sz(root, -1, 0, g);
+      head_in.resize(n), parent_in.resize(n);
+      // revをbfs順の一時領域に使う
+      bfs_parent(g, root, rev, parent, depth);
+      for(int j = n - 1; j >= 0; j--){
+        int cur = rev[j];
+        for(int i = 0; i < g[cur].size(); i++){
+          edge &e = g[cur][i];
+          if(e.t == parent[cur]) continue;
+          subsize[cur] += subsize[e.t];
+          if(heavy[cur] == -1 || subsize[g[cur][heavy[cur]].t] < subsize[e.t]){
+            heavy[cur] = i;
+          }
+        }
+      }
+      // outをスタックに使う, heavyの子 -> 軽い子(添字順)の順に訪れる
+      int sp = 0, times = 0;
+      out[sp++] = root;
       head[root] = root;
-      int t = 0;
-      dfs_hld(root, -1, t, g);
+      while(sp){
+        int cur = out[--sp];
+        in[cur] = times;
+        rev[times++] = cur;
+        int h = heavy[cur];
+        for(int i = int(g[cur].size()) - 1; i >= 0; i--){
+          int to = g[cur][i].t;
+          if(i == h || to == parent[cur]) continue;
+          head[to] = to;
+          out[sp++] = to;
+        }
+        if(h != -1){
+          head[g[cur][h].t] = head[cur];
+          out[sp++] = g[cur][h].t;
+        }
+      }
+      for(int v = 0; v < n; v++){
+        out[v] = in[v] + subsize[v];
+        head_in[in[v]] = in[head[v]];
+        parent_in[in[v]] = parent[v] == -1 ? -1 : in[parent[v]];
+      }
     }
     // k個上の祖先, k = 0なら自身, k > depth[v]なら-1
     int la(int v, int k){
@@ -187,6 +200,36 @@ namespace tree_algorithm{
       if(is_swaped) std::swap(l, r);
       return g(h(l), r);
     }
+    // 複数のパスクエリをin順の添字だけを使って処理する
+    // commutative = falseの場合u->vの順にマージする(monoid::flipが必要)
+    template<typename monoid, bool commutative = true>
+    vec<typename monoid::Val> path_query_batch(segment_tree<monoid> &seg, const vec<std::pair<int, int>> &q, bool is_edge = false){
+      using Val = typename monoid::Val;
+      static constexpr int dist_prefetch = 8;
+      int Q = q.size();
+      vec<Val> res(Q);
+      for(int i = 0; i < Q; i++){
+        if(i + dist_prefetch < Q){
+          __builtin_prefetch(&in[q[i + dist_prefetch].first]);
+          __builtin_prefetch(&in[q[i + dist_prefetch].second]);
+        }
+        int a = in[q[i].first], b = in[q[i].second];
+        Val l = monoid::id(), r = monoid::id();
+        bool is_swaped = false;
+        while(true){
+          if(a > b) std::swap(a, b), std::swap(l, r), is_swaped ^= 1;
+          int hb = head_in[b];
+          if(head_in[a] == hb) break;
+          r = monoid::merge(seg.query(hb, b + 1), r);
+          b = parent_in[hb];
+        }
+        r = monoid::merge(seg.query(a + is_edge, b + 1), r);
+        if(is_swaped) std::swap(l, r);
+        if constexpr (commutative) res[i] = monoid::merge(l, r);
+        else res[i] = monoid::merge(monoid::flip(l), r);
+      }
+      return res;
+    }
   };
 
   template<typename tree>
@@ -253,30 +296,42 @@ namespace tree_algorithm{
     dfs_order(vec<vec<edge>> &g, int root){
       build(g, root);
     }
-    void dfs_build_inner(int cur, int par, int dep, int &tpath, int &tpre, vec<vec<edge>> &g){
-      depth[cur] = dep;
-      parent[cur] = par;
-      in_path[cur] = out_path[cur] = tpath;
-      rev_path[tpath++] = cur;
-      in_pre[cur] = out_pre[cur] = tpre;
-      rev_pre[tpre++] = cur;
-      for(int i = 0; i < g[cur].size(); i++){
-        int to = g[cur][i].to();
-        if(to == par) continue;
-        dfs_build_inner(to, cur, dep + 1, tpath, tpre, g);
-        subsize[cur] += subsize[to];
-        out_path[cur] = tpath;
-        rev_path[tpath++] = cur;
-      }
-      out_pre[cur] = tpre;
-    }
+    // 再帰を使わない, 親をたどって戻るのでスタックも不要(out_preを辺のイテレータに使う)
     void build(vec<vec<edge>> &g, int root){
       int n = g.size();
       depth.resize(n), parent.resize(n), subsize.resize(n, 1);
       in_pre.resize(n), out_pre.resize(n), rev_pre.resize(n);
       in_path.resize(n), out_path.resize(n), rev_path.resize(2 * n - 1);
-      int a = 0, b = 0;
-      dfs_build_inner(root, -1, 0, a, b, g);
+      int tpath = 0, tpre = 0;
+      auto enter = [&](int cur, int par, int dep){
+        depth[cur] = dep;
+        parent[cur] = par;
+        in_path[cur] = out_path[cur] = tpath;
+        rev_path[tpath++] = cur;
+        in_pre[cur] = tpre;
+        rev_pre[tpre++] = cur;
+        out_pre[cur] = 0;
+      };
+      enter(root, -1, 0);
+      int cur = root;
+      while(cur != -1){
+        int &i = out_pre[cur];
+        if(i == g[cur].size()){
+          out_pre[cur] = in_pre[cur] + subsize[cur];
+          int par = parent[cur];
+          if(par != -1){
+            subsize[par] += subsize[cur];
+            out_path[par] = tpath;
+            rev_path[tpath++] = par;
+          }
+          cur = par;
+          continue;
+        }
+        int to = g[cur][i++].to();
+        if(to == parent[cur]) continue;
+        enter(to, cur, depth[cur] + 1);
+        cur = to;
+      }
     }
     // vがuの部分木に含まれるか(u自身も部分木)
     bool is_contained_subtree(int u, int v){
@@ -310,21 +365,22 @@ namespace tree_algorithm{
       child_in.resize(n, -1);
       parent_index.resize(n, -1);
       parent.resize(n);
-      std::queue<std::pair<int, int>> q;
-      q.push({root, -1});
-      int t = 0;
-      while(!q.empty()){
-        auto [v, p] = q.front();
-        q.pop();
-        parent[v] = p;
-        if(p != -1 && child_in[p] == -1) child_in[p] = t;
-        rev_bfs[t] = v;
-        in_bfs[v] = t++;
+      // rev_bfsをキューとして使う
+      int l = 0, t = 0;
+      parent[root] = -1;
+      rev_bfs[t++] = root;
+      while(l < t){
+        int v = rev_bfs[l];
+        int p = parent[v];
+        if(p != -1 && child_in[p] == -1) child_in[p] = l;
+        in_bfs[v] = l++;
         for(int i = 0; i < g[v].size(); i++){
-          if(g[v][i].to() == p){
+          int to = g[v][i].to();
+          if(to == p){
             parent_index[v] = i;
           }else{
-            q.push({g[v][i].to(), v});
+            parent[to] = v;
+            rev_bfs[t++] = to;
           }
         }
       }
@@ -341,10 +397,18 @@ namespace tree_algorithm{
   };
   template<typename edge>
   void tree_diameter_dfs(int cur, int par, typename edge::weight d, typename edge::weight &dmax, int &vmax, vec<vec<edge>> &g){
-    if(d > dmax) dmax = d, vmax = cur;
-    for(edge &e : g[cur]){
-      if(e.to() == par) continue;
-      tree_diameter_dfs(e.to(), cur, d + e.wei(), dmax, vmax, g);
+    using weight = typename edge::weight;
+    std::vector<std::tuple<int, int, weight>> st{{cur, par, d}};
+    while(!st.empty()){
+      auto [v, p, dv] = st.back();
+      st.pop_back();
+      if(dv > dmax) dmax = dv, vmax = v;
+      // 逆順に積んで再帰版と同じ行きがけ順にする(同じ距離ならそちらと同じ頂点を返す)
+      for(int i = (int)g[v].size() - 1; i >= 0; i--){
+        edge &e = g[v][i];
+        if(e.to() == p) continue;
+        st.push_back({e.to(), v, dv + e.wei()});
+      }
     }
   }
   // {直径, s, t}
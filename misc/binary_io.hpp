@@ -0,0 +1,36 @@
+#ifndef _BINARY_IO_H_
+#define _BINARY_IO_H_
+#include <vector>
+#include <iostream>
+#include <cstdint>
+#include <type_traits>
+
+// trivially copyableな値/vectorのバイナリ入出力
+// 読み込みに失敗した場合はstreamのfailbitが立つ
+template<typename T>
+void write_binary(std::ostream &os, const T &x){
+  static_assert(std::is_trivially_copyable<T>::value);
+  os.write(reinterpret_cast<const char*>(&x), sizeof(T));
+}
+template<typename T>
+void read_binary(std::istream &is, T &x){
+  static_assert(std::is_trivially_copyable<T>::value);
+  is.read(reinterpret_cast<char*>(&x), sizeof(T));
+}
+template<typename T>
+void write_binary(std::ostream &os, const std::vector<T> &v){
+  static_assert(std::is_trivially_copyable<T>::value);
+  uint64_t n = v.size();
+  write_binary(os, n);
+  if(n) os.write(reinterpret_cast<const char*>(v.data()), sizeof(T) * n);
+}
+template<typename T>
+void read_binary(std::istream &is, std::vector<T> &v){
+  static_assert(std::is_trivially_copyable<T>::value);
+  uint64_t n = 0;
+  read_binary(is, n);
+  if(!is) return;
+  v.resize(n);
+  if(n) is.read(reinterpret_cast<char*>(v.data()), sizeof(T) * n);
+}
+#endif
@@ -0,0 +1,22 @@
+#ifndef _CPU_FEATURE_H_
+#define _CPU_FEATURE_H_
+
+// 実行時にCPUの機能を調べて切り替える用
+// x86ならimmintrin.hを読んでSIMD_X86を定義する
+// AVX2の関数には__attribute__((target("avx2")))を付け, has_avx2()の時だけ呼ぶ(simd_template.hppと違い#pragma GCC targetは不要)
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_X86
+#endif
+
+namespace cpu_feature{
+  inline bool has_avx2(){
+#ifdef SIMD_X86
+    static const bool res = __builtin_cpu_supports("avx2");
+    return res;
+#else
+    return false;
+#endif
+  }
+}
+#endif
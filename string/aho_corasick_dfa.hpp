@@ -0,0 +1,175 @@
+#ifndef _AHO_CORASICK_DFA_H_
+#define _AHO_CORASICK_DFA_H_
+#include <vector>
+#include <string>
+#include <array>
+#include <thread>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+// バイト列用のaho_corasick, build()でトライと失敗リンクを密なDFAの遷移表に変換する
+// パターンに現れるバイトを1, 2, ..., それ以外を0にまとめて(バイトクラス)表の幅を減らす
+// 遷移表の値は 次の状態 * クラス数 (掛け算を省く), 最上位bitは出力がある状態か
+// メモリ: 状態数 * クラス数 * 4byte
+struct aho_corasick_dfa{
+private:
+  static constexpr uint32_t OUT = 1u << 31;
+  int C; // クラス数
+  std::array<uint8_t, 256> cls;
+  std::vector<std::string> pat;
+  std::vector<uint32_t> table;
+  std::vector<int> term_head, term_next; // 状態ごとにそこで終わるパターンのリスト
+  std::vector<int> dict; // 失敗リンクを辿って最初に出力がある状態, 無い場合-1
+  int max_len;
+  bool built;
+  // 状態sで終わる全てのパターンについてf(パターン番号, 終端位置)
+  template<typename F>
+  void report(int s, size_t end, F &f)const{
+    for(; s != -1; s = dict[s]){
+      for(int k = term_head[s]; k != -1; k = term_next[k]) f(k, end);
+    }
+  }
+  // [from, to)を走査, 終端位置がstart以上のものだけ報告する
+  template<typename F>
+  void scan_range(const uint8_t *s, size_t from, size_t to, size_t start, F &f)const{
+    uint32_t st = 0;
+    const uint32_t *tb = table.data();
+    const uint8_t *cl = cls.data();
+    for(size_t i = from; i < to; i++){
+      st = tb[(st & ~OUT) + cl[s[i]]];
+      if((st & OUT) && i + 1 >= start) report((st & ~OUT) / C, i + 1, f);
+    }
+  }
+public:
+  aho_corasick_dfa(): C(1), max_len(0), built(false){}
+  aho_corasick_dfa(const std::vector<std::string> &patterns): aho_corasick_dfa(){
+    for(auto &p : patterns) add(p);
+    build();
+  }
+  // パターン番号を返す, 空文字列は不可
+  int add(const std::string &p){
+    assert(!built && !p.empty());
+    pat.push_back(p);
+    return (int)pat.size() - 1;
+  }
+  int size()const{
+    return pat.size();
+  }
+  int num_states()const{
+    return dict.size();
+  }
+  void build(){
+    assert(!built);
+    built = true;
+    cls.fill(0);
+    C = 1;
+    for(auto &p : pat) for(uint8_t c : p) if(!cls[c]) cls[c] = C++;
+    // トライ(遷移が無い所は-1)
+    std::vector<int> to(C, -1);
+    int m = pat.size();
+    term_head.assign(1, -1);
+    term_next.assign(m, -1);
+    max_len = 0;
+    for(int k = 0; k < m; k++){
+      int v = 0;
+      for(uint8_t c : pat[k]){
+        int &nx = to[v * C + cls[c]];
+        if(nx == -1){
+          nx = term_head.size();
+          term_head.push_back(-1);
+          to.resize(to.size() + C, -1);
+        }
+        v = to[v * C + cls[c]];
+      }
+      term_next[k] = term_head[v];
+      term_head[v] = k;
+      max_len = std::max(max_len, (int)pat[k].size());
+    }
+    // BFSで失敗リンクと足りない遷移を埋める
+    int n = term_head.size();
+    std::vector<int> fail(n, 0), que;
+    dict.assign(n, -1);
+    que.reserve(n);
+    for(int c = 0; c < C; c++){
+      int &u = to[c];
+      if(u == -1) u = 0;
+      else que.push_back(u);
+    }
+    for(int i = 0; i < (int)que.size(); i++){
+      int v = que[i];
+      int f = fail[v];
+      dict[v] = term_head[f] != -1 ? f : dict[f];
+      for(int c = 0; c < C; c++){
+        int &u = to[v * C + c];
+        if(u == -1){
+          u = to[f * C + c];
+        }else{
+          fail[u] = to[f * C + c];
+          que.push_back(u);
+        }
+      }
+    }
+    // 浅い状態ほど頻繁に通るので, BFS順に番号を付け直して表の先頭に集める
+    assert((long long)n * C < OUT);
+    std::vector<int> ord(n);
+    ord[0] = 0;
+    for(int i = 0; i < (int)que.size(); i++) ord[que[i]] = i + 1;
+    std::vector<int> head2(n), dict2(n);
+    for(int v = 0; v < n; v++){
+      head2[ord[v]] = term_head[v];
+      dict2[ord[v]] = dict[v] == -1 ? -1 : ord[dict[v]];
+    }
+    table.resize((size_t)n * C);
+    for(int v = 0; v < n; v++){
+      for(int c = 0; c < C; c++){
+        int u = to[v * C + c];
+        table[(size_t)ord[v] * C + c] = uint32_t(ord[u] * C) | (term_head[u] != -1 || dict[u] != -1 ? OUT : 0);
+      }
+    }
+    term_head.swap(head2);
+    dict.swap(dict2);
+  }
+  // f(パターン番号, 終端位置(半開))を出現順に呼ぶ
+  template<typename F>
+  void scan(const char *s, size_t n, F f)const{
+    assert(built);
+    scan_range(reinterpret_cast<const uint8_t*>(s), 0, n, 0, f);
+  }
+  template<typename F>
+  void scan(const std::string &s, F f)const{
+    scan(s.data(), s.size(), f);
+  }
+  // 文字列をthreads個に分けて並列に走査する
+  // 各区間は(最長のパターン - 1)文字手前から走査し, 終端が区間内のものだけ報告する
+  // f(スレッド番号, パターン番号, 終端位置)は複数スレッドから同時に呼ばれる(各スレッド内では出現順)
+  template<typename F>
+  void scan_parallel(const char *s, size_t n, int threads, F f)const{
+    assert(built);
+    static constexpr size_t min_chunk = 1 << 16;
+    threads = std::max<size_t>(1, std::min<size_t>(threads, n / min_chunk));
+    const uint8_t *u = reinterpret_cast<const uint8_t*>(s);
+    auto work = [&](int id){
+      size_t l = n * id / threads, r = n * (id + 1) / threads;
+      size_t from = l > (size_t)max_len - 1 ? l - (max_len - 1) : 0;
+      auto g = [&](int k, size_t end){ f(id, k, end); };
+      scan_range(u, from, r, l + 1, g);
+    };
+    std::vector<std::thread> th;
+    for(int i = 1; i < threads; i++) th.emplace_back(work, i);
+    work(0);
+    for(auto &t : th) t.join();
+  }
+  // 全ての出現 {終端位置, パターン番号} (終端位置, 状態から辿る順)
+  std::vector<std::pair<size_t, int>> find_all(const char *s, size_t n, int threads = 1)const{
+    threads = std::max(1, threads);
+    std::vector<std::vector<std::pair<size_t, int>>> res(threads);
+    scan_parallel(s, n, threads, [&](int id, int k, size_t end){ res[id].push_back({end, k}); });
+    for(int i = 1; i < threads; i++) res[0].insert(res[0].end(), res[i].begin(), res[i].end());
+    return res[0];
+  }
+  const std::string &pattern(int k)const{
+    return pat[k];
+  }
+};
+#endif
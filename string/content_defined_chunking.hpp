@@ -0,0 +1,184 @@
+#ifndef _CONTENT_DEFINED_CHUNKING_H_
+#define _CONTENT_DEFINED_CHUNKING_H_
+#include <vector>
+#include <array>
+#include <random>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+// バイト列を少しずつ受け取る(feed)ハッシュ, 全体を保持しない
+// ファイルを分割して読んだ場合もmmapした領域を一度に渡した場合も結果は同じ
+
+// 直近w文字の多項式ハッシュ mod 2^61 - 1
+// hash = s[i - w + 1] * r^(w - 1) + ... + s[i] * r^0
+// 出ていく文字の s * r^w を256通り前計算しておき, 1文字あたり乗算1回
+struct rolling_window_hash61{
+  using ull = unsigned long long;
+  static constexpr ull mod = (1ULL << 61) - 1;
+private:
+  int w;
+  ull r, h; // hは mod以上の場合がある(getで直す)
+  size_t cnt; // これまでに受け取った文字数
+  std::vector<uint8_t> ring; // 直近w文字
+  std::array<ull, 256> out;  // out[c] := mod - c * r^w
+  static ull mul(ull a, ull b){
+    __uint128_t c = (__uint128_t)a * b;
+    ull x = (ull(c) & mod) + ull(c >> 61);
+    return x >= mod ? x - mod : x;
+  }
+  static ull add(ull a, ull b){
+    ull c = a + b;
+    return c >= mod ? c - mod : c;
+  }
+  static ull fold(ull x){
+    return (x & mod) + (x >> 61);
+  }
+  // h * r + c - o * r^w, hは[0, 2^61 + 8)のまま持ち, 比較と分岐を省く
+  ull step(ull x, uint8_t c, uint8_t o)const{
+    __uint128_t y = (__uint128_t)x * r;
+    return fold((ull(y) & mod) + ull(y >> 61) + c + out[o]);
+  }
+public:
+  // 同じ(w, seed)なら常に同じハッシュになる
+  rolling_window_hash61(int w, ull seed = 0): w(w), h(0), cnt(0), ring(w, 0){
+    assert(w > 0);
+    std::mt19937_64 rng(seed);
+    r = rng() % (mod - 2) + 2;
+    ull rw = 1;
+    for(int i = 0; i < w; i++) rw = mul(rw, r);
+    for(int c = 0; c < 256; c++) out[c] = (mod - mul(c, rw)) % mod;
+  }
+  int window()const{
+    return w;
+  }
+  // これまでに受け取った文字数
+  size_t position()const{
+    return cnt;
+  }
+  // 直近min(w, position())文字のハッシュ
+  ull get()const{
+    return h >= mod ? h - mod : h;
+  }
+  ull push(uint8_t c){
+    size_t k = cnt % w;
+    h = step(h, c, ring[k]);
+    ring[k] = c;
+    cnt++;
+    return get();
+  }
+  // 文字を受け取る度にf(終端位置(半開), 直近w文字のハッシュ), 窓が埋まるまでは呼ばない
+  template<typename F>
+  void feed(const uint8_t *s, size_t n, F f){
+    size_t k = cnt % w;
+    for(size_t i = 0; i < n; i++){
+      h = step(h, s[i], ring[k]);
+      ring[k] = s[i];
+      if(++k == (size_t)w) k = 0;
+      if(++cnt >= (size_t)w) f(cnt, get());
+    }
+  }
+  void feed(const uint8_t *s, size_t n){
+    feed(s, n, [](size_t, ull){});
+  }
+  // 長さnの列のハッシュ(窓が無限の場合)
+  ull hash(const uint8_t *s, size_t n)const{
+    ull res = 0;
+    for(size_t i = 0; i < n; i++) res = add(mul(res, r), s[i]);
+    return res;
+  }
+};
+
+// Gearハッシュ(h = 2h + gear[c], 直近64文字で決まる)による内容依存の分割(FastCDC)
+// 長さがmin_size以上でhの上位bitが全て0になる所で切る, max_sizeで強制的に切る
+// 長さがavg_size未満の間は判定に使うbitを2本増やし, 以上では2本減らす(長さの分布がavg_size付近に集まる)
+// hは直近64文字で決まるので, 各チャンクの先頭 min_size - 64 文字はハッシュを計算せずに飛ばす
+struct content_defined_chunker{
+  using ull = unsigned long long;
+private:
+  size_t min_size, avg_size, max_size;
+  ull mask_s, mask_l;
+  std::array<ull, 256> gear;
+  ull h;
+  size_t start, len; // 今のチャンクの開始位置と長さ
+  // p[0, k)をハッシュに加え, (h & mask) == 0になった所で止める, 読んだ文字数を返す
+  size_t scan(const uint8_t *p, size_t k, ull mask){
+    const ull *g = gear.data();
+    ull x = h;
+    for(size_t i = 0; i < k; i++){
+      x = (x << 1) + g[p[i]];
+      if(!(x & mask)){
+        h = x;
+        return i + 1;
+      }
+    }
+    h = x;
+    return k;
+  }
+  template<typename F>
+  void emit(F &f){
+    f(start, len);
+    start += len;
+    len = 0;
+    h = 0;
+  }
+  // 上位b bit
+  static ull top_bits(int b){
+    b = std::max(1, std::min(63, b));
+    return ~0ULL << (64 - b);
+  }
+public:
+  // min_size <= avg_size <= max_size, 同じ引数なら常に同じ位置で切る
+  content_defined_chunker(size_t min_size = 2048, size_t avg_size = 8192, size_t max_size = 65536, ull seed = 0):
+  min_size(min_size), avg_size(avg_size), max_size(max_size), h(0), start(0), len(0){
+    assert(0 < max_size && min_size <= avg_size && avg_size <= max_size);
+    int b = 0;
+    while((2ULL << b) <= avg_size) b++; // floor(log2(avg_size))
+    mask_s = top_bits(b + 2);
+    mask_l = top_bits(b - 2);
+    std::mt19937_64 rng(seed);
+    for(auto &x : gear) x = rng();
+  }
+  // これまでに受け取った文字数
+  size_t position()const{
+    return start + len;
+  }
+  // チャンクが確定する度にf(開始位置, 長さ)
+  template<typename F>
+  void feed(const uint8_t *s, size_t n, F f){
+    size_t skip = min_size > 64 ? min_size - 64 : 0;
+    size_t i = 0;
+    while(i < n){
+      if(len < skip){
+        size_t k = std::min(n - i, skip - len);
+        i += k, len += k;
+      }else if(len < min_size){
+        size_t k = std::min(n - i, min_size - len);
+        for(size_t j = 0; j < k; j++) h = (h << 1) + gear[s[i + j]];
+        i += k, len += k;
+        if(len == max_size) emit(f);
+      }else{
+        bool small = len < avg_size;
+        ull mask = small ? mask_s : mask_l;
+        size_t k = std::min(n - i, (small ? avg_size : max_size) - len);
+        size_t c = scan(s + i, k, mask);
+        i += c, len += c;
+        if(!(h & mask) || len == max_size) emit(f);
+      }
+    }
+  }
+  // 末尾の未確定のチャンク(空でなければ)
+  template<typename F>
+  void finish(F f){
+    if(len) emit(f);
+  }
+  // 全体を一度に分割する {開始位置, 長さ}
+  std::vector<std::pair<size_t, size_t>> split(const uint8_t *s, size_t n){
+    std::vector<std::pair<size_t, size_t>> res;
+    auto f = [&](size_t l, size_t k){ res.push_back({l, k}); };
+    feed(s, n, f);
+    finish(f);
+    return res;
+  }
+};
+#endif
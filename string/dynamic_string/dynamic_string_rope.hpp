@@ -0,0 +1,549 @@
+#ifndef _DYNAMIC_STRING_ROPE_H_
+#define _DYNAMIC_STRING_ROPE_H_
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include "../rolling_hash.hpp"
+
+// dynamic_stringの葉に最大B文字をまとめたもの(rope)
+// AVL木の各ノードが1つのチャンク(葉)を持ち, チャンクのハッシュと部分木のハッシュを持つ
+// 1文字あたりのメモリ: sizeof(T) * (1 ~ 2) + 約180 / B byte (dynamic_stringは約40byte)
+// 挿入/削除/set/split/merge O(logN + B), hash_range O(logN + B), lcp O(logN * (logN + B))
+// split, mergeはチャンクの境目で木を分ける/繋ぐ(AVLのjoin), 分割位置を含む1チャンクだけを2つに分け, 境目の隣り合うチャンクが合わせてB文字以下なら1つにする
+// persistent = trueの場合, 変更する経路のノードと変更するチャンクだけをコピーする(他のチャンクは共有)
+template<typename T, int B, bool persistent>
+struct __dynamic_string_rope{
+  using ull = unsigned long long;
+  using rh = montgomery_rolling_hash;
+  static_assert(2 <= B && B <= (1 << 15));
+  struct leaf{
+    ull hash; // s[0] * r^0 + s[1] * r^1 + ...
+    int len;
+    T s[B];
+  };
+  struct node{
+    node *l, *r;
+    leaf *c;
+    int h, sz;
+    ull sum;
+    node(leaf *c): l(nullptr), r(nullptr), c(c), h(1), sz(c->len), sum(c->hash){}
+  };
+  static inline node *tmp_node = nullptr;
+  static node *own(node *v){
+    if constexpr(persistent) return new node(*v);
+    else return v;
+  }
+  static leaf *own(leaf *c){
+    if constexpr(persistent) return new leaf(*c);
+    else return c;
+  }
+  static int size(node *v){
+    return v ? v->sz : 0;
+  }
+  static int height(node *v){
+    return v ? v->h : 0;
+  }
+  // s[0, n)のハッシュ
+  static ull hash_of(const T *s, int n){
+    ull res = 0;
+    for(int i = 0; i < n; i++) res = rh::add(res, rh::mul(rh::__mod(s[i]), rh::rpow[i]));
+    return res;
+  }
+  static leaf *make_leaf(const T *s, int n){
+    leaf *c = new leaf();
+    std::copy(s, s + n, c->s);
+    c->len = n;
+    c->hash = hash_of(s, n);
+    return c;
+  }
+  static void update(node *v){
+    v->h = std::max(height(v->l), height(v->r)) + 1;
+    int szl = size(v->l);
+    v->sz = szl + v->c->len + size(v->r);
+    ull s = rh::mul(v->c->hash, rh::rpow[szl]);
+    if(v->l) s = rh::add(v->l->sum, s);
+    if(v->r) s = rh::add(s, rh::mul(v->r->sum, rh::rpow[szl + v->c->len]));
+    v->sum = s;
+  }
+  static node *rotate_right(node *v){
+    node *l = own(v->l);
+    v->l = l->r;
+    l->r = v;
+    update(v);
+    update(l);
+    return l;
+  }
+  static node *rotate_left(node *v){
+    node *r = own(v->r);
+    v->r = r->l;
+    r->l = v;
+    update(v);
+    update(r);
+    return r;
+  }
+  // vはコピー済み
+  static node *balance(node *v){
+    int bf = height(v->l) - height(v->r);
+    if(bf == 2){
+      if(height(v->l->l) < height(v->l->r)){
+        v->l = own(v->l);
+        v->l = rotate_left(v->l);
+      }
+      return rotate_right(v);
+    }else if(bf == -2){
+      if(height(v->r->r) < height(v->r->l)){
+        v->r = own(v->r);
+        v->r = rotate_right(v->r);
+      }
+      return rotate_left(v);
+    }
+    return v;
+  }
+  static node *build(const std::vector<node*> &nodes, int l, int r){
+    if(l == r) return nullptr;
+    int m = (l + r) >> 1;
+    node *v = nodes[m];
+    v->l = build(nodes, l, m);
+    v->r = build(nodes, m + 1, r);
+    update(v);
+    return v;
+  }
+  static node *insert_leftmost(node *v, node *u){
+    if(!v) return u;
+    v = own(v);
+    v->l = insert_leftmost(v->l, u);
+    update(v);
+    return balance(v);
+  }
+  static node *cut_leftmost(node *v){
+    v = own(v);
+    if(v->l){
+      v->l = cut_leftmost(v->l);
+      update(v);
+      return balance(v);
+    }
+    tmp_node = v;
+    return v->r;
+  }
+  static node *cut_rightmost(node *v){
+    v = own(v);
+    if(v->r){
+      v->r = cut_rightmost(v->r);
+      update(v);
+      return balance(v);
+    }
+    tmp_node = v;
+    return v->l;
+  }
+  // l, m, rの順に並べた木, mはコピー済みで子は無視する O(|height(l) - height(r)| + 1)
+  static node *join(node *l, node *m, node *r){
+    int hl = height(l), hr = height(r);
+    if(hl > hr + 1){
+      l = own(l);
+      l->r = join(l->r, m, r);
+      update(l);
+      return balance(l);
+    }
+    if(hr > hl + 1){
+      r = own(r);
+      r->l = join(l, m, r->l);
+      update(r);
+      return balance(r);
+    }
+    m->l = l;
+    m->r = r;
+    update(m);
+    return m;
+  }
+  // 境目の2つのチャンクが合わせてB文字以下なら1つにする
+  static node *merge_inner(node *a, node *b){
+    if(!a) return b;
+    if(!b) return a;
+    node *x = a, *y = b;
+    while(x->r) x = x->r;
+    while(y->l) y = y->l;
+    int lx = x->c->len, ly = y->c->len;
+    b = cut_leftmost(b);
+    node *m = tmp_node;
+    if(lx + ly <= B){
+      a = cut_rightmost(a);
+      node *u = tmp_node;
+      leaf *c = u->c = own(u->c), *d = m->c;
+      std::copy(d->s, d->s + ly, c->s + lx);
+      c->hash = rh::add(c->hash, rh::mul(d->hash, rh::rpow[lx]));
+      c->len += ly;
+      if constexpr(!persistent){
+        delete d;
+        delete m;
+      }
+      m = u;
+    }
+    return join(a, m, b);
+  }
+  // {[0, k), [k, n)}, kがチャンクの途中ならそのチャンクを2つに分ける
+  static std::pair<node*, node*> split_inner(node *v, int k){
+    if(!v) return {nullptr, nullptr};
+    if(k == 0) return {nullptr, v};
+    if(k == v->sz) return {v, nullptr};
+    int szl = size(v->l), len = v->c->len;
+    node *l = v->l, *r = v->r;
+    if(k <= szl){
+      auto [a, b] = split_inner(l, k);
+      return {a, join(b, own(v), r)};
+    }
+    if(k >= szl + len){
+      auto [a, b] = split_inner(r, k - szl - len);
+      return {join(l, own(v), a), b};
+    }
+    int p = k - szl;
+    node *m = own(v);
+    leaf *c = m->c = own(m->c), *d = make_leaf(c->s + p, len - p);
+    c->hash = rh::sub(c->hash, rh::mul(d->hash, rh::rpow[p]));
+    c->len = p;
+    m->l = m->r = nullptr;
+    update(m);
+    // 分けた2つは隣のチャンクと合わせられれば1つにする
+    return {merge_inner(l, m), merge_inner(new node(d), r)};
+  }
+  static node *insert_inner(node *v, int k, const T &x){
+    if(!v) return new node(make_leaf(&x, 1));
+    v = own(v);
+    int szl = size(v->l), len = v->c->len;
+    if(k < szl){
+      v->l = insert_inner(v->l, k, x);
+    }else if(k > szl + len){
+      v->r = insert_inner(v->r, k - szl - len, x);
+    }else if(len < B){
+      leaf *c = v->c = own(v->c);
+      int p = k - szl;
+      // 短い方の側のハッシュを数え直す
+      ull suf;
+      if(p < len - p) suf = rh::sub(c->hash, hash_of(c->s, p));
+      else suf = rh::mul(hash_of(c->s + p, len - p), rh::rpow[p]);
+      ull pre = rh::sub(c->hash, suf);
+      std::copy_backward(c->s + p, c->s + len, c->s + len + 1);
+      c->s[p] = x;
+      c->len++;
+      c->hash = rh::add(rh::add(pre, rh::mul(rh::__mod(x), rh::rpow[p])), rh::mul(suf, rh::rpow[1]));
+    }else{
+      // 満杯のチャンクは2つに分け, 後半を右の部分木の最左に入れる
+      T tmp[B + 1];
+      int p = k - szl;
+      std::copy(v->c->s, v->c->s + p, tmp);
+      tmp[p] = x;
+      std::copy(v->c->s + p, v->c->s + len, tmp + p + 1);
+      int half = (B + 1) / 2;
+      leaf *c = v->c = own(v->c);
+      std::copy(tmp, tmp + half, c->s);
+      c->len = half;
+      c->hash = hash_of(c->s, half);
+      v->r = insert_leftmost(v->r, new node(make_leaf(tmp + half, B + 1 - half)));
+    }
+    update(v);
+    return balance(v);
+  }
+  static node *erase_inner(node *v, int k){
+    v = own(v);
+    int szl = size(v->l), len = v->c->len;
+    if(k < szl){
+      v->l = erase_inner(v->l, k);
+    }else if(k >= szl + len){
+      v->r = erase_inner(v->r, k - szl - len);
+    }else if(len == 1){
+      node *l = v->l, *r = v->r;
+      if constexpr(!persistent){
+        delete v->c;
+        delete v;
+      }
+      if(!r) return l;
+      node *u = cut_leftmost(r);
+      tmp_node->l = l;
+      tmp_node->r = u;
+      v = tmp_node;
+    }else{
+      leaf *c = v->c = own(v->c);
+      int p = k - szl;
+      ull suf;
+      if(p < len - p) suf = rh::sub(c->hash, hash_of(c->s, p));
+      else suf = rh::mul(hash_of(c->s + p, len - p), rh::rpow[p]);
+      ull pre = rh::sub(c->hash, suf);
+      suf = rh::sub(suf, rh::mul(rh::__mod(c->s[p]), rh::rpow[p]));
+      std::copy(c->s + p + 1, c->s + len, c->s + p);
+      c->len--;
+      c->hash = rh::add(pre, rh::mul(suf, rh::rinvpow[1]));
+      // 小さくなったチャンクは次のチャンクと合わせる
+      if(c->len < B / 4 && v->r){
+        node *m = v->r;
+        while(m->l) m = m->l;
+        if(c->len + m->c->len <= B * 3 / 4){
+          v->r = cut_leftmost(v->r);
+          leaf *d = tmp_node->c;
+          std::copy(d->s, d->s + d->len, c->s + c->len);
+          c->hash = rh::add(c->hash, rh::mul(d->hash, rh::rpow[c->len]));
+          c->len += d->len;
+          if constexpr(!persistent){
+            delete d;
+            delete tmp_node;
+          }
+        }
+      }
+    }
+    update(v);
+    return balance(v);
+  }
+  static node *set_inner(node *v, int k, const T &x){
+    v = own(v);
+    int szl = size(v->l), len = v->c->len;
+    if(k < szl){
+      v->l = set_inner(v->l, k, x);
+    }else if(k >= szl + len){
+      v->r = set_inner(v->r, k - szl - len, x);
+    }else{
+      leaf *c = v->c = own(v->c);
+      int p = k - szl;
+      ull d = rh::sub(rh::__mod(x), rh::__mod(c->s[p]));
+      c->hash = rh::add(c->hash, rh::mul(d, rh::rpow[p]));
+      c->s[p] = x;
+    }
+    update(v);
+    return v;
+  }
+  static T get_inner(node *v, int k){
+    while(true){
+      int szl = size(v->l), len = v->c->len;
+      if(k < szl){
+        v = v->l;
+      }else if(k >= szl + len){
+        k -= szl + len;
+        v = v->r;
+      }else{
+        return v->c->s[k - szl];
+      }
+    }
+  }
+  static ull hash_inner(node *v, int l, int r){
+    if(!v || l >= r) return 0;
+    if(l == 0 && r == v->sz) return v->sum;
+    int szl = size(v->l), len = v->c->len;
+    ull res = 0;
+    int off = 0; // 結果の中での位置
+    if(l < szl){
+      res = hash_inner(v->l, l, std::min(r, szl));
+      off = std::min(r, szl) - l;
+    }
+    int a = std::max(l, szl) - szl, b = std::min(r, szl + len) - szl;
+    if(a < b){
+      ull h = (a == 0 && b == len) ? v->c->hash : hash_of(v->c->s + a, b - a);
+      res = rh::add(res, rh::mul(h, rh::rpow[off]));
+      off += b - a;
+    }
+    if(r > szl + len){
+      ull h = hash_inner(v->r, std::max(0, l - szl - len), r - szl - len);
+      res = rh::add(res, rh::mul(h, rh::rpow[off]));
+    }
+    return res;
+  }
+  template<typename F>
+  static void enumerate(node *v, int l, int r, F &f){
+    if(!v || l >= r) return;
+    int szl = size(v->l), len = v->c->len;
+    if(l < szl) enumerate(v->l, l, std::min(r, szl), f);
+    for(int i = std::max(l, szl); i < std::min(r, szl + len); i++) f(v->c->s[i - szl]);
+    if(r > szl + len) enumerate(v->r, std::max(0, l - szl - len), r - szl - len, f);
+  }
+  // チャンクのs[a, len)とbの[pos, ...)のlcp, hb(l, r) := bの[l, r)のハッシュ
+  template<typename H>
+  static int chunk_lcp(const leaf *c, int a, int pos, int nb, H &hb){
+    int k = std::min(c->len - a, nb - pos);
+    if(k <= 0) return 0;
+    std::vector<ull> pre(k + 1, 0);
+    for(int i = 0; i < k; i++) pre[i + 1] = rh::add(pre[i], rh::mul(rh::__mod(c->s[a + i]), rh::rpow[i]));
+    if(pre[k] == hb(pos, pos + k)) return k;
+    int L = 0, R = k;
+    while(R - L > 1){
+      int mid = (L + R) >> 1;
+      if(pre[mid] == hb(pos, pos + mid)) L = mid;
+      else R = mid;
+    }
+    return L;
+  }
+  // vの[l1, ...)とbの[l2, ...)のlcp, nb := bの長さ
+  template<typename H>
+  static int lcp_inner(node *v, int l1, int l2, int nb, H &hb){
+    if(!v || l1 >= v->sz || l2 >= nb) return 0;
+    if(l1 == 0 && l2 + v->sz <= nb && v->sum == hb(l2, l2 + v->sz)) return v->sz;
+    int szl = size(v->l), len = v->c->len;
+    if(l1 >= szl + len) return lcp_inner(v->r, l1 - szl - len, l2, nb, hb);
+    int L = 0;
+    if(l1 < szl){
+      L = lcp_inner(v->l, l1, l2, nb, hb);
+      if(L != szl - l1) return L;
+      l1 = szl;
+    }
+    int a = l1 - szl, m = chunk_lcp(v->c, a, l2 + L, nb, hb);
+    L += m;
+    if(m != len - a) return L;
+    return L + lcp_inner(v->r, 0, l2 + L, nb, hb);
+  }
+  static node *build(const std::vector<T> &v){
+    int n = v.size();
+    std::vector<node*> nodes;
+    for(int i = 0; i < n; i += B) nodes.push_back(new node(make_leaf(v.data() + i, std::min(B, n - i))));
+    return build(nodes, 0, nodes.size());
+  }
+};
+
+// 各チャンクは最大B文字
+// get, to_vectorはハッシュではなく元の値を返す
+template<typename T = char, int B = 128>
+struct dynamic_string_rope{
+  using ull = unsigned long long;
+  using rh = montgomery_rolling_hash;
+private:
+  using core = __dynamic_string_rope<T, B, false>;
+  using node = typename core::node;
+  node *root;
+  dynamic_string_rope(node *root): root(root){}
+public:
+  dynamic_string_rope(): root(nullptr){}
+  dynamic_string_rope(const std::vector<T> &v): root(core::build(v)){}
+  int size()const{
+    return core::size(root);
+  }
+  void set(int k, T x){
+    assert(0 <= k && k < size());
+    root = core::set_inner(root, k, x);
+  }
+  T get(int k)const{
+    assert(0 <= k && k < size());
+    return core::get_inner(root, k);
+  }
+  void insert(int k, T x){
+    assert(0 <= k && k <= size());
+    root = core::insert_inner(root, k, x);
+  }
+  void erase(int k){
+    assert(0 <= k && k < size());
+    root = core::erase_inner(root, k);
+  }
+  ull hash_range(int l, int r)const{
+    assert(0 <= l && r <= size());
+    if(l >= r) return 0;
+    return core::hash_inner(root, l, r);
+  }
+  ull hash_all()const{
+    return root ? root->sum : 0;
+  }
+  std::pair<dynamic_string_rope, dynamic_string_rope> split(int k){
+    return split(*this, k);
+  }
+  // 2つに分割. 永続でないためaのrootはnullptrになる O(logN + B)
+  static std::pair<dynamic_string_rope, dynamic_string_rope> split(dynamic_string_rope &a, int k){
+    assert(0 <= k && k <= a.size());
+    auto [l, r] = core::split_inner(a.root, k);
+    a.root = nullptr;
+    return {dynamic_string_rope(l), dynamic_string_rope(r)};
+  }
+  // a, bをマージ. 永続でないためa, bのrootはnullptrになる O(logN + B)
+  static dynamic_string_rope merge(dynamic_string_rope &a, dynamic_string_rope &b){
+    dynamic_string_rope res(core::merge_inner(a.root, b.root));
+    a.root = b.root = nullptr;
+    return res;
+  }
+  // [l, r)
+  std::vector<T> to_vector(int l, int r)const{
+    assert(0 <= l && r <= size());
+    std::vector<T> res;
+    auto f = [&](const T &x){ res.push_back(x); };
+    core::enumerate(root, l, r, f);
+    return res;
+  }
+  std::vector<T> to_vector()const{
+    return to_vector(0, size());
+  }
+  // S := size(), hash_range(l, r)を持つ (rolling_hash_string, dynamic_rolling_hash_string, dynamic_stringなど)
+  template<typename S>
+  static int lcp(const dynamic_string_rope &a, const S &b, int l1, int l2){
+    auto hb = [&](int l, int r){ return b.hash_range(l, r); };
+    return core::lcp_inner(a.root, l1, l2, b.size(), hb);
+  }
+  template<typename S>
+  static int lcp(const S &a, const dynamic_string_rope &b, int l1, int l2){
+    return lcp(b, a, l2, l1);
+  }
+  static int lcp(const dynamic_string_rope &a, const dynamic_string_rope &b, int l1, int l2){
+    auto hb = [&](int l, int r){ return b.hash_range(l, r); };
+    return core::lcp_inner(a.root, l1, l2, b.size(), hb);
+  }
+};
+
+// dynamic_string_persistentと同じ使い方, 変更した版の根を返す
+template<typename T = char, int B = 128>
+struct dynamic_string_rope_persistent{
+  using ull = unsigned long long;
+  using rh = montgomery_rolling_hash;
+private:
+  using core = __dynamic_string_rope<T, B, true>;
+public:
+  using node = typename core::node;
+  static node *build(const std::vector<T> &v){
+    return core::build(v);
+  }
+  static int size(node *v){
+    return core::size(v);
+  }
+  static node *set(node *v, int k, T x){
+    assert(0 <= k && k < size(v));
+    return core::set_inner(v, k, x);
+  }
+  static T get(node *v, int k){
+    assert(0 <= k && k < size(v));
+    return core::get_inner(v, k);
+  }
+  static node *insert(node *v, int k, T x){
+    assert(0 <= k && k <= size(v));
+    return core::insert_inner(v, k, x);
+  }
+  static node *erase(node *v, int k){
+    assert(0 <= k && k < size(v));
+    return core::erase_inner(v, k);
+  }
+  static ull hash_range(node *v, int l, int r){
+    assert(0 <= l && r <= size(v));
+    if(l >= r) return 0;
+    return core::hash_inner(v, l, r);
+  }
+  static ull hash_all(node *v){
+    return v ? v->sum : 0;
+  }
+  // 2つに分割, vは変わらない
+  static std::pair<node*, node*> split(node *v, int k){
+    assert(0 <= k && k <= size(v));
+    return core::split_inner(v, k);
+  }
+  // a, bをマージ, a, bは変わらない(同じ版同士をマージしてもいい)
+  static node *merge(node *a, node *b){
+    return core::merge_inner(a, b);
+  }
+  static std::vector<T> to_vector(node *v){
+    std::vector<T> res;
+    auto f = [&](const T &x){ res.push_back(x); };
+    core::enumerate(v, 0, size(v), f);
+    return res;
+  }
+  // S := size(), hash_range(l, r)を持つ
+  template<typename S>
+  static int lcp(node *v, const S &b, int l1, int l2){
+    auto hb = [&](int l, int r){ return b.hash_range(l, r); };
+    return core::lcp_inner(v, l1, l2, b.size(), hb);
+  }
+  template<typename S>
+  static int lcp(const S &a, node *v, int l1, int l2){
+    return lcp(v, a, l2, l1);
+  }
+  static int lcp(node *v, node *u, int l1, int l2){
+    auto hb = [&](int l, int r){ return hash_range(u, l, r); };
+    return core::lcp_inner(v, l1, l2, size(u), hb);
+  }
+};
+#endif
@@ -0,0 +1,148 @@
+#ifndef _FM_INDEX_H_
+#define _FM_INDEX_H_
+#include <vector>
+#include <string>
+#include <array>
+#include <cassert>
+#include <iostream>
+#include "string.hpp"
+#include "../data_structure/bit_sequence/wavelet_matrix.hpp"
+#include "../data_structure/bit_sequence/bitvector.hpp"
+#include "../misc/binary_io.hpp"
+
+// 末尾に番兵$(最小)を付けたT$のBWTをwavelet_matrixに載せる
+// 出現する文字だけを1, 2, ...に詰める($は0), 1文字あたり約2ceil(log(σ + 1))bit
+// 接尾辞配列はテキスト上の位置がrateの倍数のものだけ持つ
+// count O(|P|logσ), locate O((|P| + occ * rate)logσ), extract O((r - l + rate)logσ)
+struct fm_index{
+private:
+  int n, rate, sigma; // nは$を含む長さ
+  std::array<int, 256> code; // 文字 -> 1, 2, ..., 無い文字は-1
+  std::vector<uint8_t> decode;
+  std::vector<int> C; // C[c] := BWT中のc未満の文字の数
+  wavelet_matrix wm;
+  bitvector_memory sampled; // sampled[i] := sa[i] % rate == 0
+  std::vector<int> ssa; // サンプルされたsa[i] / rate (iの順)
+  std::vector<int> isa; // isa[k] := 接尾辞k * rateの順位
+  // LF(i) = C[bwt[i]] + rank(i, bwt[i])
+  std::pair<int, int> lf(int i){
+    auto [c, r] = wm.access_rank(i);
+    return {c, C[c] + r};
+  }
+  // T$での接尾辞posの順位, posはrateの倍数かn - 1
+  int rank_of(int pos){
+    return pos == n - 1 ? 0 : isa[pos / rate];
+  }
+public:
+  fm_index(): n(0){}
+  fm_index(const std::string &s, int rate = 32): fm_index(s.data(), s.size(), rate){}
+  fm_index(const char *s, size_t len, int rate = 32): n(len + 1), rate(rate){
+    assert(rate > 0 && len < (size_t)std::numeric_limits<int>::max());
+    code.fill(-1);
+    for(size_t i = 0; i < len; i++) code[(uint8_t)s[i]] = 0;
+    sigma = 1;
+    decode.push_back(0);
+    for(int c = 0; c < 256; c++){
+      if(code[c] == 0){
+        code[c] = sigma++;
+        decode.push_back(c);
+      }
+    }
+    // T$の接尾辞配列は先頭に$の接尾辞を付けたもの
+    std::vector<int> sa = suffix_array_bytes<int>(s, len);
+    std::vector<int> bwt(n);
+    std::vector<bool> bits(n, false);
+    isa.resize(len / rate + 1);
+    for(int i = 0; i < n; i++){
+      int p = i == 0 ? len : sa[i - 1];
+      bwt[i] = p == 0 ? 0 : code[(uint8_t)s[p - 1]];
+      if(p % rate == 0){
+        bits[i] = true;
+        ssa.push_back(p / rate);
+        isa[p / rate] = i;
+      }
+    }
+    std::vector<int>().swap(sa);
+    C.assign(sigma + 1, 0);
+    for(int i = 0; i < n; i++) C[bwt[i] + 1]++;
+    for(int c = 0; c < sigma; c++) C[c + 1] += C[c];
+    wm = wavelet_matrix(bwt, sigma, false);
+    sampled = bitvector_memory(bits);
+  }
+  // 元の文字列の長さ
+  int size()const{
+    return n - 1;
+  }
+  // パターンpが接頭辞になる接尾辞の順位の区間[l, r) (T$の接尾辞配列上)
+  std::pair<int, int> range(const std::string &p){
+    int l = 0, r = n;
+    for(int i = (int)p.size() - 1; i >= 0 && l < r; i--){
+      int c = code[(uint8_t)p[i]];
+      if(c == -1) return {0, 0};
+      l = C[c] + wm.rank(l, c);
+      r = C[c] + wm.rank(r, c);
+    }
+    return {l, r};
+  }
+  // pの出現回数
+  int count(const std::string &p){
+    auto [l, r] = range(p);
+    return std::max(0, r - l);
+  }
+  // 順位iの接尾辞の位置(T$上), サンプルされた所までLFを辿る
+  int locate_row(int i){
+    int step = 0;
+    while(!sampled.access(i)){
+      i = lf(i).second;
+      step++;
+    }
+    return ssa[sampled.rank1(i)] * rate + step;
+  }
+  // pの出現位置(昇順とは限らない)
+  std::vector<int> locate(const std::string &p){
+    auto [l, r] = range(p);
+    std::vector<int> res;
+    for(int i = l; i < r; i++) res.push_back(locate_row(i));
+    return res;
+  }
+  // 元の文字列の[l, r)
+  std::string extract(int l, int r){
+    assert(0 <= l && l <= r && r <= n - 1);
+    if(l == r) return "";
+    int p = std::min(n - 1, (r + rate - 1) / rate * rate), i = rank_of(p);
+    std::string res(r - l, 0);
+    // bwt[i]はT[p - 1]
+    while(p > l){
+      auto [c, j] = lf(i);
+      p--;
+      if(p < r) res[p - l] = decode[c];
+      i = j;
+    }
+    return res;
+  }
+  void save(std::ostream &os)const{
+    write_binary(os, n);
+    write_binary(os, rate);
+    write_binary(os, sigma);
+    write_binary(os, code);
+    write_binary(os, decode);
+    write_binary(os, C);
+    wm.save(os);
+    sampled.save(os);
+    write_binary(os, ssa);
+    write_binary(os, isa);
+  }
+  void load(std::istream &is){
+    read_binary(is, n);
+    read_binary(is, rate);
+    read_binary(is, sigma);
+    read_binary(is, code);
+    read_binary(is, decode);
+    read_binary(is, C);
+    wm.load(is);
+    sampled.load(is);
+    read_binary(is, ssa);
+    read_binary(is, isa);
+  }
+};
+#endif
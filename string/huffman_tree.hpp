@@ -2,7 +2,11 @@
 #define _HUFFMAN_TREE_H_
 #include <vector>
 #include <string>
+#include <array>
 #include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
 #include "../data_structure/basic/binary_heap.hpp"
 
 // n - 1個の追加ノードを含むグラフを構築
@@ -18,7 +22,7 @@ std::vector<std::pair<int, int>> huffman_tree(const std::vector<Val> &v){
   assert(n);
   std::vector<std::pair<Val, int>> tmp(n);
   for(int i = 0; i < n; i++) tmp[i] = {v[i], i};
-  binary_heap_map<Val, int> h(tmp);
+  binary_heap_map<Val, int, std::less<Val>> h(tmp);
   std::vector<std::pair<int, int>> ans(2 * n - 1, {-1, -1});
   while(h.size() >= 2){
     auto [x, xi] = h.pop_min();
@@ -43,6 +47,211 @@ std::vector<std::string> huffman_code(const std::vector<Val> &v){
   ans.resize(n);
   return ans;
 }
+// ハフマン符号の長さ(= ハフマン木の葉の深さ), n = 1の場合{1}
+template<typename Val>
+std::vector<int> huffman_code_length(const std::vector<Val> &v){
+  int n = v.size();
+  assert(n);
+  if(n == 1) return {1};
+  auto t = huffman_tree<Val>(v);
+  std::vector<int> d(2 * n - 1, 0);
+  for(int i = 2 * n - 2; i >= n; i--) d[t[i].first] = d[t[i].second] = d[i] + 1;
+  d.resize(n);
+  return d;
+}
+// 長さがmax_len以下の符号の中で ∑長さ×重み が最小のものの長さ(package-merge), O(N max_len)
+// 重みが0の要素は長さ0(符号を割り当てない), 重みが正の要素が1個ならその長さは1
+// 重みが正の要素の数 <= 2^max_len
+// 段jの列 := 葉と, 段j - 1の列を先頭から2個ずつまとめたもの, を重みの昇順にマージした列
+// 最後の段の先頭2m - 2個を選び, 選んだまとめたものがp個なら一つ前の段の先頭2p個を選ぶ, を繰り返す
+// 各葉の長さ = 選ばれた回数
+template<typename Val>
+std::vector<int> huffman_code_length_limited(const std::vector<Val> &v, int max_len){
+  int n = v.size();
+  std::vector<int> len(n, 0), leaf;
+  for(int i = 0; i < n; i++) if(v[i] > 0) leaf.push_back(i);
+  int m = leaf.size();
+  if(m <= 1){
+    if(m == 1) len[leaf[0]] = 1;
+    return len;
+  }
+  assert(max_len >= 31 || (1LL << max_len) >= m);
+  max_len = std::min(max_len, m - 1); // これより長い符号は不要
+  std::stable_sort(leaf.begin(), leaf.end(), [&](int a, int b){ return v[a] < v[b]; });
+  std::vector<std::vector<int>> kind(max_len); // 葉ならleafの添字, まとめたものなら-1
+  std::vector<Val> cur(m), nxt;
+  for(int k = 0; k < m; k++) cur[k] = v[leaf[k]], kind[0].push_back(k);
+  for(int j = 1; j < max_len; j++){
+    int a = 0, b = 0, np = cur.size() / 2;
+    nxt.clear();
+    while(a < m || b < np){
+      if(b == np || (a < m && v[leaf[a]] <= cur[2 * b] + cur[2 * b + 1])){
+        nxt.push_back(v[leaf[a]]);
+        kind[j].push_back(a++);
+      }else{
+        nxt.push_back(cur[2 * b] + cur[2 * b + 1]);
+        kind[j].push_back(-1);
+        b++;
+      }
+    }
+    cur.swap(nxt);
+  }
+  int take = 2 * m - 2;
+  for(int j = max_len - 1; j >= 0; j--){
+    assert(take <= (int)kind[j].size());
+    int p = 0;
+    for(int k = 0; k < take; k++){
+      if(kind[j][k] == -1) p++;
+      else len[leaf[kind[j][k]]]++;
+    }
+    take = 2 * p;
+  }
+  return len;
+}
+
+// バイト列用の標準ハフマン符号(canonical), 符号長はMAX_LEN以下
+// 符号は(長さ, 文字)の順に小さい値を割り当て, ビット列の下位bitから詰める(deflateと同じ)
+// 符号長の列(lengths())だけで同じ符号を復元できる
+// 復号: 次のMAX_LEN bitで引く表(4096要素)に, その中に収まる先頭最大3文字と消費するbit数を入れておく
+// 64bitのバッファに8バイトずつ読み足し, 1回の補充で4回表を引く
+// リトルエンディアンを仮定
+struct huffman_codec{
+  static constexpr int MAX_LEN = 12;
+private:
+  static constexpr int TB = MAX_LEN;
+  std::vector<int> len;
+  std::array<uint32_t, 256> enc; // 反転した符号 | 長さ << 16
+  // 下位3バイト: 文字, 24, 25bit: 文字数, 26bit-: 消費するbit数
+  std::vector<uint32_t> dec;
+  void build(){
+    assert(len.size() <= 256);
+    len.resize(256, 0);
+    enc.fill(0);
+    // 長さごとの最初の符号
+    std::array<int, MAX_LEN + 2> cnt{}, next{};
+    for(int c = 0; c < 256; c++){
+      assert(0 <= len[c] && len[c] <= MAX_LEN);
+      if(len[c]) cnt[len[c]]++;
+    }
+    for(int l = 1, code = 0; l <= MAX_LEN; l++){
+      code = (code + cnt[l - 1]) << 1;
+      next[l] = code;
+    }
+    std::vector<uint8_t> sym1(1 << TB, 0), len1(1 << TB, 1); // 1文字だけ復号する表, 不正な符号は文字0, 1bit
+    for(int c = 0; c < 256; c++){
+      int l = len[c];
+      if(!l) continue;
+      uint32_t code = next[l]++, r = 0;
+      for(int k = 0; k < l; k++) r |= ((code >> k) & 1) << (l - 1 - k);
+      enc[c] = r | (uint32_t)l << 16;
+      for(uint32_t x = r; x < (1u << TB); x += 1u << l) sym1[x] = c, len1[x] = l;
+    }
+    dec.resize(1 << TB);
+    for(uint32_t x = 0; x < (1u << TB); x++){
+      uint32_t e = 0;
+      int used = 0, k = 0;
+      while(k < 3){
+        uint32_t y = x >> used;
+        if(used + len1[y] > TB) break;
+        e |= (uint32_t)sym1[y] << (8 * k);
+        used += len1[y];
+        k++;
+      }
+      dec[x] = e | (uint32_t)k << 24 | (uint32_t)used << 26;
+    }
+  }
+public:
+  // len[c] := 文字cの符号長(0なら現れない), 符号が完全でない(Kraftの和 < 1)場合, 空いている符号は不正
+  huffman_codec(const std::vector<int> &_len): len(_len){
+    build();
+  }
+  // sの頻度から作る
+  huffman_codec(const uint8_t *s, size_t n){
+    std::vector<long long> freq(256, 0);
+    for(size_t i = 0; i < n; i++) freq[s[i]]++;
+    len = huffman_code_length_limited(freq, MAX_LEN);
+    build();
+  }
+  const std::vector<int> &lengths()const{
+    return len;
+  }
+  // 符号化した時のbit数
+  size_t encoded_bits(const uint8_t *s, size_t n)const{
+    size_t res = 0;
+    for(size_t i = 0; i < n; i++) res += len[s[i]];
+    return res;
+  }
+  // 符号長が0の文字を含んではいけない
+  std::vector<uint8_t> encode(const uint8_t *s, size_t n)const{
+    std::vector<uint8_t> res(n * MAX_LEN / 8 + 16);
+    uint8_t *out = res.data();
+    uint64_t buf = 0;
+    int cnt = 0;
+    size_t i = 0;
+    auto put = [&](uint8_t c){
+      uint32_t e = enc[c];
+      assert(e);
+      buf |= (uint64_t)(e & 0xffff) << cnt;
+      cnt += e >> 16;
+    };
+    auto flush = [&](){
+      memcpy(out, &buf, 8);
+      out += cnt >> 3;
+      buf >>= cnt & ~7;
+      cnt &= 7;
+    };
+    for(; i + 4 <= n; i += 4){ // 7 + 4 * 12 < 64
+      put(s[i]), put(s[i + 1]), put(s[i + 2]), put(s[i + 3]);
+      flush();
+    }
+    for(; i < n; i++) put(s[i]);
+    flush();
+    if(cnt) *out++ = buf;
+    res.resize(out - res.data());
+    return res;
+  }
+  std::vector<uint8_t> encode(const std::vector<uint8_t> &s)const{
+    return encode(s.data(), s.size());
+  }
+  // encodeした長さmのバイト列sから先頭n文字を復号する
+  std::vector<uint8_t> decode(const uint8_t *s, size_t m, size_t n)const{
+    std::vector<uint8_t> res(n + 16);
+    uint8_t *out = res.data(), *out_end = out + n;
+    const uint8_t *p = s, *end = s + m;
+    const uint32_t *tb = dec.data();
+    uint64_t buf = 0;
+    int cnt = 0;
+    auto step = [&](){
+      uint32_t e = tb[buf & ((1 << TB) - 1)];
+      memcpy(out, &e, 4);
+      out += (e >> 24) & 3;
+      buf >>= e >> 26;
+      cnt -= e >> 26;
+    };
+    // 補充の後cnt >= 56, 1回の補充で4 * 3文字まで書く
+    while(p + 8 <= end && out + 12 <= out_end){
+      uint64_t x;
+      memcpy(&x, p, 8);
+      buf |= x << cnt;
+      p += (63 - cnt) >> 3;
+      cnt |= 56;
+      step(), step(), step(), step();
+    }
+    // 末尾は1バイトずつ読み, 足りない分は0で埋める(n文字を超えて書いた分は捨てる)
+    while(out < out_end){
+      while(cnt <= 56){
+        buf |= (uint64_t)(p < end ? *p++ : 0) << cnt;
+        cnt += 8;
+      }
+      step();
+    }
+    res.resize(n);
+    return res;
+  }
+  std::vector<uint8_t> decode(const std::vector<uint8_t> &s, size_t n)const{
+    return decode(s.data(), s.size(), n);
+  }
+};
 
 /*
 template<typename Val>
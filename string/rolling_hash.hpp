@@ -1,10 +1,80 @@
 #ifndef _ROLLING_HASH_H_
 #define _ROLLING_HASH_H_
 #include <vector>
+#include <array>
+#include <cassert>
 #include "string_basic.hpp"
 #include "../misc/random_number.hpp"
 #include "../math/integer.hpp"
 #include "../math/prime.hpp"
+#include "../simd/cpu_feature.hpp"
+
+namespace rolling_hash_internal{
+#ifdef SIMD_X86
+  // 64bit * 64bit -> 128bitを32bitの積4回で, {上位, 下位}
+  __attribute__((target("avx2")))
+  inline __m256i mul_full(__m256i a, __m256i b, __m256i &lo){
+    const __m256i m32 = _mm256_set1_epi64x(0xffffffff);
+    __m256i ah = _mm256_srli_epi64(a, 32), bh = _mm256_srli_epi64(b, 32);
+    __m256i ll = _mm256_mul_epu32(a, b), lh = _mm256_mul_epu32(a, bh);
+    __m256i hl = _mm256_mul_epu32(ah, b), hh = _mm256_mul_epu32(ah, bh);
+    __m256i mid = _mm256_add_epi64(_mm256_srli_epi64(ll, 32), _mm256_add_epi64(_mm256_and_si256(lh, m32), _mm256_and_si256(hl, m32)));
+    lo = _mm256_or_si256(_mm256_and_si256(ll, m32), _mm256_slli_epi64(mid, 32));
+    return _mm256_add_epi64(_mm256_add_epi64(hh, _mm256_srli_epi64(mid, 32)), _mm256_add_epi64(_mm256_srli_epi64(lh, 32), _mm256_srli_epi64(hl, 32)));
+  }
+  // 64bit * 64bit の下位64bit
+  __attribute__((target("avx2")))
+  inline __m256i mul_lo(__m256i a, __m256i b){
+    __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)), _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b));
+    return _mm256_add_epi64(_mm256_mul_epu32(a, b), _mm256_slli_epi64(cross, 32));
+  }
+  // a >= bなら全bit1 (符号なし)
+  __attribute__((target("avx2")))
+  inline __m256i ge(__m256i a, __m256i b){
+    const __m256i sign = _mm256_set1_epi64x(1ULL << 63);
+    return _mm256_cmpgt_epi64(_mm256_xor_si256(a, sign), _mm256_xor_si256(_mm256_sub_epi64(b, _mm256_set1_epi64x(1)), sign));
+  }
+  // montgomery_reduction_64bit::mulと同じ (a * b + m * mod) / 2^64, [0, 2mod)
+  __attribute__((target("avx2")))
+  inline __m256i mont_mul(__m256i a, __m256i b, __m256i mod, __m256i neg_inv){
+    __m256i lo, lo2;
+    __m256i hi = mul_full(a, b, lo);
+    __m256i hi2 = mul_full(mul_lo(lo, neg_inv), mod, lo2);
+    // lo + lo2は0か2^64
+    __m256i carry = _mm256_add_epi64(_mm256_set1_epi64x(1), _mm256_cmpeq_epi64(lo, _mm256_setzero_si256()));
+    return _mm256_add_epi64(_mm256_add_epi64(hi, hi2), carry);
+  }
+  // a, b < modの和
+  __attribute__((target("avx2")))
+  inline __m256i add_mod(__m256i a, __m256i b, __m256i mod){
+    __m256i c = _mm256_add_epi64(a, b);
+    return _mm256_sub_epi64(c, _mm256_and_si256(ge(c, mod), mod));
+  }
+  // res[i + 1] = res[i] + mul(rpow[i], x(i)) (mod) を i = 0, 4, 8...について4要素ずつ, 処理した要素数を返す
+  // 4要素の積をまとめて計算し, レジスタ内で累積和を取ってから直前までの和を足す
+  template<typename F>
+  __attribute__((target("avx2")))
+  int prefix_hash_avx2(const unsigned long long *rpow, F x, int n, unsigned long long _mod, unsigned long long *res){
+    unsigned long long inv = _mod;
+    for(int i = 0; i < 5; i++) inv *= 2 - _mod * inv;
+    const __m256i mod = _mm256_set1_epi64x(_mod), neg_inv = _mm256_set1_epi64x(-inv), zero = _mm256_setzero_si256();
+    __m256i carry = _mm256_set1_epi64x(res[0]);
+    int i = 0;
+    for(; i + 4 <= n; i += 4){
+      __m256i v = _mm256_set_epi64x(x(i + 3), x(i + 2), x(i + 1), x(i));
+      __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rpow + i));
+      __m256i t = mont_mul(r, v, mod, neg_inv);
+      t = _mm256_sub_epi64(t, _mm256_and_si256(ge(t, mod), mod));
+      t = add_mod(t, _mm256_blend_epi32(_mm256_permute4x64_epi64(t, 0x90), zero, 0x03), mod); // [0, t0, t1, t2]
+      t = add_mod(t, _mm256_blend_epi32(_mm256_permute4x64_epi64(t, 0x40), zero, 0x0f), mod); // [0, 0, t0, t1]
+      t = add_mod(t, carry, mod);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(res + i + 1), t);
+      carry = _mm256_permute4x64_epi64(t, 0xff);
+    }
+    return i;
+  }
+#endif
+}
 
 // 要素はモンゴメリ表現に変換せずに演算する
 struct montgomery_rolling_hash{
@@ -40,6 +110,8 @@ struct montgomery_rolling_hash{
   }
   template<typename T>
   static ull __mod(T x){
+    // mod > 2^58なので32bit以下の非負整数はそのまま(割り算を省く)
+    if constexpr(std::is_integral<T>::value && sizeof(T) <= 4) if(x >= 0) return x;
     x %= mod;
     return x < 0 ? mod + x : x;
   }
@@ -58,12 +130,19 @@ struct montgomery_rolling_hash{
     return mr.fix(res);
   }
   // table[i] = [0, i)のハッシュテーブル
+  // AVX2が使える場合は4要素ずつ計算する(結果は同じ)
   template<typename T>
   static std::vector<ull> hash_table(const std::vector<T> &s){
     assert(s.size() <= rpow.size());
-    std::vector<ull> res(s.size() + 1);
+    int n = s.size(), i = 0;
+    std::vector<ull> res(n + 1);
     res[0] = 0;
-    for(int i = 0; i < s.size(); i++){
+#ifdef SIMD_X86
+    if(cpu_feature::has_avx2()){
+      i = rolling_hash_internal::prefix_hash_avx2(rpow.data(), [&](int k){ return (long long)__mod(s[k]); }, n, mod, res.data());
+    }
+#endif
+    for(; i < n; i++){
       res[i + 1] = mr.add_safe(res[i], mr.mul(rpow[i], __mod(s[i])));
     }
     return res;
@@ -304,6 +383,60 @@ public:
   int lcp(const rolling_hash_string &b, int l1, int l2) const{
     return lcp(*this, b, l1, l2);
   }
+  // res[i] := lcp(a, b, Q[i].first, Q[i].second)
+  // G個の二分探索を1段ずつ交互に進め, 次に読む位置をprefetchしてメモリの待ち時間を隠す
+  // 終わったものから次のクエリを入れる
+  static std::vector<int> lcp_batch(const rolling_hash_string &a, const rolling_hash_string &b, const std::vector<std::pair<int, int>> &Q){
+    static constexpr int G = 16;
+    int q = Q.size(), next = 0, active = 0;
+    std::vector<int> res(q);
+    std::array<int, G> id, L, R;
+    auto prefetch = [&](int k){
+      int mid = (L[k] + R[k]) >> 1;
+      auto [l1, l2] = Q[id[k]];
+      __builtin_prefetch(&a.sum[l1 + mid]);
+      __builtin_prefetch(&b.sum[l2 + mid]);
+    };
+    auto start = [&](int k){
+      while(next < q){
+        auto [l1, l2] = Q[next];
+        assert(0 <= l1 && l1 <= a.size() && 0 <= l2 && l2 <= b.size());
+        id[k] = next++;
+        L[k] = 0, R[k] = std::min(a.size() - l1, b.size() - l2) + 1;
+        if(R[k] - L[k] > 1){
+          __builtin_prefetch(&a.sum[l1]);
+          __builtin_prefetch(&b.sum[l2]);
+          __builtin_prefetch(&rh::rinvpow[l1]);
+          __builtin_prefetch(&rh::rinvpow[l2]);
+          prefetch(k);
+          return true;
+        }
+        res[id[k]] = 0;
+      }
+      return false;
+    };
+    for(int k = 0; k < G && start(k); k++) active++;
+    while(active){
+      for(int k = 0; k < active; k++){
+        auto [l1, l2] = Q[id[k]];
+        int mid = (L[k] + R[k]) >> 1;
+        if(a.hash_range(l1, l1 + mid) == b.hash_range(l2, l2 + mid)) L[k] = mid;
+        else R[k] = mid;
+        if(R[k] - L[k] > 1){
+          prefetch(k);
+          continue;
+        }
+        res[id[k]] = L[k];
+        if(!start(k)){
+          // 末尾の枠を詰める
+          active--;
+          id[k] = id[active], L[k] = L[active], R[k] = R[active];
+          k--;
+        }
+      }
+    }
+    return res;
+  }
 };
 
 struct dynamic_rolling_hash_string{
@@ -9,8 +9,13 @@
 #include <array>
 #include <cassert>
 #include <queue>
+#include <thread>
+#include <limits>
+#include <cstdint>
+#include <type_traits>
 #include "string_basic.hpp"
 #include "../data_structure/range_query/sparse_table.hpp"
+#include "../data_structure/range_query/rmq_succinct.hpp"
 
 template<typename Val, Val (*id)()>
 struct trie{
@@ -357,6 +362,186 @@ std::vector<int> sa_is(const std::vector<int>& s, int upper){
   }
   return sa;
 }
+// バイト列用のSA-IS
+// 入力をintに変換せず直接読む, 添字の型Idxを選べる(符号付き, 2^31文字以上はlong long)
+// threadsで並列になるのはL/S型の判定, バケットの数え上げ, LMS部分文字列の比較だけ
+// 時間の大半の誘導ソートは逐次なので, threadsを増やしてもほとんど速くならない
+// (ブロックごとに読む文字を並列に先読みする版は, 1コアでは読み込みが2回になるだけで倍近く遅かったので消した)
+namespace suffix_array_internal{
+  template<typename F>
+  void parallel_run(int threads, const F &f){
+    if(threads <= 1){
+      f(0);
+      return;
+    }
+    std::vector<std::thread> th;
+    for(int i = 1; i < threads; i++) th.emplace_back(f, i);
+    f(0);
+    for(auto &t : th) t.join();
+  }
+  // [0, n)をthreads個に分けた時のid番目の区間, 境界は64の倍数
+  template<typename Idx>
+  std::pair<Idx, Idx> split_range(Idx n, int threads, int id){
+    Idx w = ((n + threads - 1) / threads + 63) / 64 * 64;
+    return {std::min(n, w * id), std::min(n, w * (id + 1))};
+  }
+  // ls[i] := s[i...n)がS型か (s[n - 1]はL型)
+  struct type_bits{
+    std::vector<uint64_t> b;
+    type_bits(size_t n): b((n >> 6) + 1, 0){}
+    bool get(size_t i)const{ return (b[i >> 6] >> (i & 63)) & 1; }
+    void set(size_t i, bool f){
+      if(f) b[i >> 6] |= 1ULL << (i & 63);
+      else b[i >> 6] &= ~(1ULL << (i & 63));
+    }
+  };
+  template<typename Idx, typename Char>
+  void sa_naive(const Char *s, Idx n, Idx *sa){
+    std::iota(sa, sa + n, Idx(0));
+    std::sort(sa, sa + n, [&](Idx l, Idx r){
+      if(l == r) return false;
+      while(l < n && r < n){
+        if(s[l] != s[r]) return s[l] < s[r];
+        l++, r++;
+      }
+      return l == n;
+    });
+  }
+  // s[i] <= upper, sa[0, n)に書き込む
+  template<typename Idx, typename Char>
+  void sa_is(const Char *s, Idx n, Idx upper, Idx *sa, int threads){
+    static constexpr Idx THRESHOLD_NAIVE = 40;
+    static constexpr Idx BLOCK = 1 << 16;
+    if(n < THRESHOLD_NAIVE){
+      sa_naive(s, n, sa);
+      return;
+    }
+    threads = std::max(1, std::min<int>(threads, n / BLOCK));
+    type_bits ls(n);
+    // 1. L/S型
+    // 区間ごとに右から決める, 区間の右端と同じ文字が続く部分は次の区間が決まってから埋める
+    std::vector<Idx> undecided(threads);
+    parallel_run(threads, [&](int id){
+      auto [a, b] = split_range(n, threads, id);
+      if(a == b) return;
+      Idx i = b - 1;
+      if(b == n) ls.set(--i + 1, false);
+      else while(i >= a && s[i] == s[b]) i--;
+      undecided[id] = i + 1;
+      for(; i >= a; i--) ls.set(i, s[i] == s[i + 1] ? ls.get(i + 1) : s[i] < s[i + 1]);
+    });
+    for(int id = threads - 1; id >= 0; id--){
+      auto [a, b] = split_range(n, threads, id);
+      if(b == n) continue;
+      bool f = ls.get(b);
+      for(Idx i = undecided[id]; i < b; i++) ls.set(i, f);
+    }
+    auto is_lms = [&](Idx i){ return i > 0 && ls.get(i) && !ls.get(i - 1); };
+    // 2. バケット
+    std::vector<Idx> sum_l(upper + 2, 0), sum_s(upper + 2, 0);
+    {
+      int th = (upper < (1 << 16) ? threads : 1);
+      std::vector<std::vector<Idx>> cl(th, std::vector<Idx>(upper + 1, 0)), cs = cl;
+      parallel_run(th, [&](int id){
+        auto [a, b] = split_range(n, th, id);
+        for(Idx i = a; i < b; i++){
+          if(ls.get(i)) cs[id][s[i]]++;
+          else cl[id][s[i]]++;
+        }
+      });
+      Idx sum = 0;
+      for(Idx c = 0; c <= upper; c++){
+        sum_l[c] = sum;
+        for(int id = 0; id < th; id++) sum += cl[id][c];
+        sum_s[c] = sum;
+        for(int id = 0; id < th; id++) sum += cs[id][c];
+      }
+      sum_l[upper + 1] = sum_s[upper + 1] = n;
+    }
+    // 3. 誘導ソート(逐次), 16個先のsa[j] - 1の文字を先読みする
+    std::vector<Idx> buf(upper + 2);
+    auto induce = [&](const std::vector<Idx> &lms){
+      std::fill(sa, sa + n, Idx(-1));
+      std::copy(sum_s.begin(), sum_s.end(), buf.begin());
+      for(Idx d : lms) sa[buf[s[d]]++] = d;
+      std::copy(sum_l.begin(), sum_l.end(), buf.begin());
+      sa[buf[s[n - 1]]++] = n - 1;
+      for(Idx i = 0; i < n; i++){
+        Idx v = sa[i];
+        if(v < 1) continue;
+        if(i + 16 < n && sa[i + 16] >= 1) __builtin_prefetch(&s[sa[i + 16] - 1]);
+        if(!ls.get(v - 1)) sa[buf[s[v - 1]]++] = v - 1;
+      }
+      std::copy(sum_l.begin(), sum_l.end(), buf.begin());
+      for(Idx i = n - 1; i >= 0; i--){
+        Idx v = sa[i];
+        if(v < 1) continue;
+        if(i >= 16 && sa[i - 16] >= 1) __builtin_prefetch(&s[sa[i - 16] - 1]);
+        if(ls.get(v - 1)) sa[--buf[s[v - 1] + 1]] = v - 1;
+      }
+    };
+    std::vector<Idx> lms;
+    for(Idx i = 1; i < n; i++) if(is_lms(i)) lms.push_back(i);
+    Idx m = lms.size();
+    induce(lms);
+    if(m == 0) return;
+    // 4. LMS部分文字列に名前を付ける
+    // LMSは2以上離れているので, 位置pの情報をsa[m + p / 2]に置ける
+    Idx k = 0;
+    for(Idx i = 0; i < n; i++) if(is_lms(sa[i])) sa[k++] = sa[i];
+    for(Idx i = 0; i < m; i++) sa[m + lms[i] / 2] = (i + 1 < m ? lms[i + 1] : n) - lms[i];
+    std::vector<uint8_t> diff(m, 0);
+    parallel_run(threads, [&](int id){
+      auto [a, b] = split_range(m, threads, id);
+      for(Idx i = std::max<Idx>(a, 1); i < b; i++){
+        Idx l = sa[i - 1], r = sa[i];
+        Idx len = sa[m + l / 2];
+        if(len != sa[m + r / 2] || l + len == n || r + len == n){
+          diff[i] = 1;
+          continue;
+        }
+        for(Idx j = 0; j <= len; j++){
+          if(s[l + j] != s[r + j]){
+            diff[i] = 1;
+            break;
+          }
+        }
+      }
+    });
+    Idx rec_upper = 0;
+    for(Idx i = 0; i < m; i++){
+      rec_upper += diff[i];
+      sa[m + sa[i] / 2] = rec_upper;
+    }
+    std::vector<Idx> rec_s(m);
+    for(Idx i = 0; i < m; i++) rec_s[i] = sa[m + lms[i] / 2];
+    // 5. 再帰
+    if(rec_upper + 1 == m){
+      for(Idx i = 0; i < m; i++) sa[rec_s[i]] = i;
+    }else{
+      sa_is<Idx, Idx>(rec_s.data(), m, rec_upper, sa, threads);
+    }
+    std::vector<Idx>().swap(rec_s);
+    for(Idx i = 0; i < m; i++) sa[i] = lms[sa[i]];
+    std::copy(sa, sa + m, lms.begin());
+    induce(lms);
+  }
+}
+// 長さnのバイト列の接尾辞配列, suffix_array(std::string)と同じ結果(文字はunsignedとして比較)
+// Idxは符号付き(size_t等では誘導ソートの番兵-1が使えない), 2^31文字を超える場合はlong long
+// threadsは速度を上げる設定ではない(上を参照), 既定は1
+template<typename Idx = int>
+std::vector<Idx> suffix_array_bytes(const uint8_t *s, size_t n, int threads = 1){
+  static_assert(std::is_signed<Idx>::value, "Idx must be signed (use long long for texts over 2^31)");
+  assert(n <= (size_t)std::numeric_limits<Idx>::max());
+  std::vector<Idx> sa(n);
+  if(n) suffix_array_internal::sa_is<Idx, uint8_t>(s, Idx(n), Idx(255), sa.data(), std::max(threads, 1));
+  return sa;
+}
+template<typename Idx = int>
+std::vector<Idx> suffix_array_bytes(const char *s, size_t n, int threads = 1){
+  return suffix_array_bytes<Idx>(reinterpret_cast<const uint8_t*>(s), n, threads);
+}
 std::vector<int> suffix_array(const std::vector<int>& s, int upper) {
   assert(0 <= upper);
   for (int d : s) assert(0 <= d && d <= upper);
@@ -380,10 +565,7 @@ std::vector<int> suffix_array(const std::vector<T>& s) {
 }
 
 std::vector<int> suffix_array(const std::string& s) {
-  int n = int(s.size());
-  std::vector<int> s2(n);
-  for (int i = 0; i < n; i++) s2[i] = s[i];
-  return sa_is(s2, 255);
+  return suffix_array_bytes<int>(s.data(), s.size(), 1);
 }
 
 // lcp[i] := substr(sa[i] ... n)とsubstr(sa[i + 1]...n)の接頭辞の共通する文字の数
@@ -455,6 +637,85 @@ struct lcp_arbitrary_pair{
   }
 };
 
+// plcp[i] := substr(i...n)と辞書順で次の接尾辞のlcp (lcp[rank[i]]と同じ)
+// Φ配列を使う, O(N)
+template<typename T>
+std::vector<int> plcp_array(const std::vector<T> &s, const std::vector<int> &sa){
+  int n = s.size();
+  std::vector<int> phi(n);
+  for(int i = 0; i < n; i++) phi[sa[i]] = i + 1 < n ? sa[i + 1] : -1;
+  for(int i = 0, h = 0; i < n; i++){
+    int j = phi[i];
+    if(j == -1){
+      phi[i] = h = 0;
+      continue;
+    }
+    while(i + h < n && j + h < n && s[i + h] == s[j + h]) h++;
+    phi[i] = h;
+    if(h > 0) h--;
+  }
+  return phi;
+}
+std::vector<int> plcp_array(const std::string &s, const std::vector<int> &sa){
+  return plcp_array(std::vector<char>(s.begin(), s.end()), sa);
+}
+
+// lcp_arbitrary_pairのsparse_tableを使わない版
+// plcp[i] + 2iに1を立てたビット列(2Nbit)でplcpを持ち, lcp配列の最小の位置をrmq_succinct(約3.5Nbit)で求める
+// sa, rank以外は O(N)bit
+struct lcp_arbitrary_pair_succinct{
+  std::vector<int> sa;
+  std::vector<int> rank;
+private:
+  bitvector_succinct plcp_bits;
+  rmq_succinct st;
+  void build(const std::vector<int> &plcp){
+    int n = sa.size();
+    std::vector<uint64_t> w((2 * (long long)n >> 6) + 1, 0);
+    for(int i = 0; i < n; i++){
+      long long p = plcp[i] + 2LL * i;
+      w[p >> 6] |= 1ULL << (p & 63);
+    }
+    plcp_bits = bitvector_succinct(std::move(w), 2 * n);
+    st = rmq_succinct(n, [&](int k){ return plcp[sa[k]]; });
+  }
+public:
+  template<typename T>
+  lcp_arbitrary_pair_succinct(const std::vector<T> &s): sa(suffix_array(s)), rank(rank_array(sa)){
+    build(plcp_array(s, sa));
+  }
+  lcp_arbitrary_pair_succinct(const std::string &s): sa(suffix_array(s)), rank(rank_array(sa)){
+    build(plcp_array(s, sa));
+  }
+  lcp_arbitrary_pair_succinct(const std::vector<int> _sa, const std::vector<int> _lcp, const std::vector<int> _rank): sa(_sa), rank(_rank){
+    int n = sa.size();
+    std::vector<int> plcp(n);
+    for(int i = 0; i < n; i++) plcp[sa[i]] = _lcp[i];
+    build(plcp);
+  }
+  // plcp[i] (i番目の接尾辞と辞書順で次の接尾辞のlcp)
+  int plcp(int i){
+    return plcp_bits.select1(i) - 2 * i;
+  }
+  // v[i...n)とv[j...n)のlcp
+  int lcp(int i, int j){
+    if(i == j) return rank.size() - i;
+    i = rank[i], j = rank[j];
+    if(i > j) std::swap(i, j);
+    return plcp(sa[st.query(i, j)]);
+  }
+  // v[i...n) <= v[j...n)か
+  // i == jのときのみ等号が成り立つ
+  bool compare(int i, int j){
+    if(i == j) return true;
+    int len = lcp(i, j);
+    int n = rank.size();
+    if(i + len == n) return true;
+    if(j + len == n) return false;
+    return rank[i + len] <= rank[j + len];
+  }
+};
+
 // z[i] := lcp(substr(0...n), substr(i...n))
 template<typename T>
 std::vector<int> z_algorithm(const std::vector<T>& s){
@@ -543,9 +804,13 @@ public:
   }
   // 一致する場所を返す
   std::vector<int> find(const std::vector<T> &s){
-    int n = s.size();
     std::vector<int> res;
-    for(int i = 0, j = 0; i < n;){
+    find(s.data(), s.size(), 0, res);
+    return res;
+  }
+  // s[from, n)の中で一致する場所をresに追加する
+  void find(const T *s, int n, int from, std::vector<int> &res)const{
+    for(int i = from, j = 0; i < n;){
       while(j >= 0 && s[i] != pat[j]) j = t[j];
       i++, j++;
       if(j == (int)pat.size()){
@@ -553,7 +818,9 @@ public:
         j = t[j];
       }
     }
-    return res;
+  }
+  const std::vector<T> &pattern()const{
+    return pat;
   }
 };
 #endif
@@ -2,6 +2,11 @@
 #define _STRING_BASIC_H_
 #include <vector>
 #include <string>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+#include "../simd/cpu_feature.hpp"
 
 std::vector<char> stovector(const std::string &s){
   int n = s.size();
@@ -123,4 +128,222 @@ public:
     return select(rank(i + 1, c) - 1, c);
   }
 };
-#endif
\ No newline at end of file
+
+// string_processorと同じ使い方で省メモリ版, NUM_VAL <= 256
+// 文字は1byteずつ持ち, 256文字(ブロック)ごとに各cについて(c以下の文字の数)をスーパーブロック(65536文字)からの相対値(16bit)で,
+// スーパーブロックごとに32bitで持つ(NUM_VAL = 26で selectの索引と合わせて1文字あたり約1.8byte, 疎なグループが最も多い場合は約2.6byte, string_processorは約9byte)
+// ブロック内はAVX2で32文字ずつ比較してpopcount
+// select: cのK個ごとのグループについて先頭の位置を持ち, そこからSIMDでk % K番目を探す
+// グループの幅がSCANを超える(疎な)場合は全ての位置を持つ, どちらもO(1)
+// 疎なグループは1文字につきN / SCAN個以下なので, 全ての位置を持つ表は全体でmin(N, NUM_VAL * N / SCAN * K)個(4byte)以下
+// find_next, find_prev: まずiの近く(SCAN文字)をSIMDで探し, 無ければrank + select
+template<int NUM_VAL = 26>
+struct string_processor_compact{
+  static_assert(0 < NUM_VAL && NUM_VAL <= 256);
+private:
+  static constexpr int BLOCK = 256, SUPER = 65536, K = 8, SCAN = 1024;
+  static constexpr int BPS = SUPER / BLOCK; // 1スーパーブロックのブロック数
+  int N, NB;
+  std::vector<uint8_t> data; // 末尾に32byteの余白
+  std::vector<uint32_t> super_le;
+  std::vector<uint16_t> block_le;
+  // sample[sample_off[c] + j] := jK番目のcの位置, 疎なグループなら~(sparseでの位置)
+  std::vector<int> sample, sparse;
+  std::array<int, NUM_VAL + 1> sample_off;
+  std::array<int, NUM_VAL> total_le;
+#ifdef SIMD_X86
+  // p[0, n)の中で, le ? c以下 : cと等しい文字の位置のビット列を32文字ずつ
+  template<bool le>
+  __attribute__((target("avx2")))
+  static uint32_t mask32(const uint8_t *p, uint8_t c){
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), y = _mm256_set1_epi8(c);
+    if constexpr(le) return _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(x, y), x));
+    else return _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y));
+  }
+  template<bool le>
+  __attribute__((target("avx2,popcnt")))
+  static int count_avx2(const uint8_t *p, int n, uint8_t c){
+    int res = 0;
+    for(; n >= 32; p += 32, n -= 32) res += __builtin_popcount(mask32<le>(p, c));
+    if(n) res += __builtin_popcount(mask32<le>(p, c) & ((1u << n) - 1));
+    return res;
+  }
+  // k番目(0-indexed)の位置, 範囲内にあることが保証されている
+  template<bool le>
+  __attribute__((target("avx2,popcnt")))
+  static int nth_avx2(const uint8_t *p, int k, uint8_t c){
+    for(int i = 0; ; i += 32){
+      uint32_t m = mask32<le>(p + i, c);
+      int pc = __builtin_popcount(m);
+      if(k < pc){
+        while(k--) m &= m - 1;
+        return i + __builtin_ctz(m);
+      }
+      k -= pc;
+    }
+  }
+  // [l, r)で最も左のc, ない場合は-1
+  __attribute__((target("avx2")))
+  static int scan_next_avx2(const uint8_t *p, int l, int r, uint8_t c){
+    for(; l < r; l += 32){
+      uint32_t m = mask32<false>(p + l, c);
+      if(r - l < 32) m &= (1u << (r - l)) - 1;
+      if(m) return l + __builtin_ctz(m);
+    }
+    return -1;
+  }
+  // [l, r)で最も右のc, ない場合は-1
+  __attribute__((target("avx2")))
+  static int scan_prev_avx2(const uint8_t *p, int l, int r, uint8_t c){
+    while(l < r){
+      int s = std::max(l, r - 32);
+      uint32_t m = mask32<false>(p + s, c);
+      if(r - s < 32) m &= (1u << (r - s)) - 1;
+      if(m) return s + 31 - __builtin_clz(m);
+      r = s;
+    }
+    return -1;
+  }
+#endif
+  template<bool le>
+  static int count(const uint8_t *p, int n, uint8_t c){
+#ifdef SIMD_X86
+    if(cpu_feature::has_avx2()) return count_avx2<le>(p, n, c);
+#endif
+    int res = 0;
+    for(int i = 0; i < n; i++) res += le ? p[i] <= c : p[i] == c;
+    return res;
+  }
+  template<bool le>
+  static int nth(const uint8_t *p, int k, uint8_t c){
+#ifdef SIMD_X86
+    if(cpu_feature::has_avx2()) return nth_avx2<le>(p, k, c);
+#endif
+    for(int i = 0; ; i++){
+      if(le ? p[i] <= c : p[i] == c){
+        if(k-- == 0) return i;
+      }
+    }
+  }
+  int scan_next(int l, int r, int c)const{
+#ifdef SIMD_X86
+    if(cpu_feature::has_avx2()) return scan_next_avx2(data.data(), l, r, c);
+#endif
+    for(; l < r; l++) if(data[l] == c) return l;
+    return -1;
+  }
+  int scan_prev(int l, int r, int c)const{
+#ifdef SIMD_X86
+    if(cpu_feature::has_avx2()) return scan_prev_avx2(data.data(), l, r, c);
+#endif
+    while(l < r) if(data[--r] == c) return r;
+    return -1;
+  }
+  // ブロックbより前のc以下の文字の数
+  int block_rank_le(int b, int c)const{
+    if(c < 0) return 0;
+    return super_le[(b / BPS) * NUM_VAL + c] + block_le[b * NUM_VAL + c];
+  }
+  int block_rank(int b, int c)const{
+    return block_rank_le(b, c) - block_rank_le(b, c - 1);
+  }
+public:
+  string_processor_compact(): N(0), NB(0){}
+  string_processor_compact(const std::vector<int> &v): N(v.size()), NB(N / BLOCK + 1){
+    data.resize(N + 32, 0);
+    std::array<int, NUM_VAL> cnt, cnt_super;
+    cnt.fill(0);
+    super_le.resize((NB + BPS - 1) / BPS * NUM_VAL);
+    block_le.resize(NB * NUM_VAL);
+    for(int b = 0; b < NB; b++){
+      if(b % BPS == 0){
+        for(int c = 0, s = 0; c < NUM_VAL; c++) super_le[(b / BPS) * NUM_VAL + c] = s += cnt[c];
+        cnt_super = cnt;
+      }
+      for(int c = 0, s = 0; c < NUM_VAL; c++) block_le[b * NUM_VAL + c] = s += cnt[c] - cnt_super[c];
+      for(int i = b * BLOCK; i < std::min(N, (b + 1) * BLOCK); i++){
+        int x = v[i];
+        assert(0 <= x && x < NUM_VAL);
+        data[i] = x;
+        cnt[x]++;
+      }
+    }
+    for(int c = 0, s = 0; c < NUM_VAL; c++) total_le[c] = s += cnt[c];
+    sample_off[0] = 0;
+    for(int c = 0; c < NUM_VAL; c++) sample_off[c + 1] = sample_off[c] + (cnt[c] + K - 1) / K;
+    sample.resize(sample_off[NUM_VAL]);
+    // 今のグループの位置, グループが埋まるか末尾に来たら幅を見て疎ならsparseに移す
+    std::vector<std::array<int, K>> buf(NUM_VAL);
+    auto flush = [&](int c, int j, int m, int p1){
+      if(p1 - buf[c][0] <= SCAN){
+        sample[sample_off[c] + j] = buf[c][0];
+        return;
+      }
+      sample[sample_off[c] + j] = ~(int)sparse.size();
+      sparse.insert(sparse.end(), buf[c].begin(), buf[c].begin() + m);
+    };
+    cnt.fill(0);
+    for(int i = 0; i < N; i++){
+      int x = data[i];
+      if(cnt[x] % K == 0 && cnt[x]) flush(x, cnt[x] / K - 1, K, i);
+      buf[x][cnt[x] % K] = i;
+      cnt[x]++;
+    }
+    for(int c = 0; c < NUM_VAL; c++){
+      if(cnt[c]) flush(c, (cnt[c] - 1) / K, (cnt[c] - 1) % K + 1, N);
+    }
+  }
+  int size()const{
+    return N;
+  }
+  // count c, i < r
+  int rank(int r, int c)const{
+    assert(0 <= r && r <= N);
+    assert(0 <= c && c < NUM_VAL);
+    int b = r / BLOCK;
+    return block_rank(b, c) + count<false>(data.data() + b * BLOCK, r % BLOCK, c);
+  }
+  // count [0, c], i < r
+  int rank_lower(int r, int c)const{
+    assert(0 <= r && r <= N);
+    assert(0 <= c && c < NUM_VAL);
+    int b = r / BLOCK;
+    return block_rank_le(b, c) + count<true>(data.data() + b * BLOCK, r % BLOCK, c);
+  }
+  // k番目のc, ない場合は-1 O(1)
+  int select(int k, int c)const{
+    assert(0 <= c && c < NUM_VAL);
+    int tot = total_le[c] - (c ? total_le[c - 1] : 0);
+    if(k < 0 || tot <= k) return -1;
+    int p = sample[sample_off[c] + k / K];
+    if(p < 0) return sparse[~p + k % K];
+    return p + nth<false>(data.data() + p, k % K, c);
+  }
+  // k番目のc以下, ない場合は-1 O(logN)
+  int select_lower(int k, int c)const{
+    assert(0 <= c && c < NUM_VAL);
+    if(k < 0 || total_le[c] <= k) return -1;
+    int lb = 0, rb = NB;
+    while(rb - lb > 1){
+      int mid = (lb + rb) >> 1;
+      if(block_rank_le(mid, c) <= k) lb = mid;
+      else rb = mid;
+    }
+    return lb * BLOCK + nth<true>(data.data() + lb * BLOCK, k - block_rank_le(lb, c), c);
+  }
+  // [i, n)で最も左のc, ない場合は-1
+  int find_next(int i, int c)const{
+    assert(0 <= c && c < NUM_VAL);
+    int r = std::min(N, i + SCAN), res = scan_next(i, r, c);
+    if(res != -1 || r == N) return res;
+    return select(rank(r, c), c);
+  }
+  // [0, i]で最も右のc, ない場合は-1
+  int find_prev(int i, int c)const{
+    assert(0 <= c && c < NUM_VAL);
+    int l = std::max(0, i + 1 - SCAN), res = scan_prev(l, i + 1, c);
+    if(res != -1 || l == 0) return res;
+    return select(rank(l, c) - 1, c);
+  }
+};
+#endif
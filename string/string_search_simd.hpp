@@ -0,0 +1,180 @@
+#ifndef _STRING_SEARCH_SIMD_H_
+#define _STRING_SEARCH_SIMD_H_
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <numeric>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include "string.hpp"
+#include "../simd/cpu_feature.hpp"
+
+// 1バイトの文字の列(char, uint8_tなど)用の検索, AVX2が使えない環境ではスカラーで動く
+// AVX2の関数は__attribute__((target("avx2")))を付けて実行時に切り替える(#pragma GCC targetは不要)
+
+// kmp_algorithmと同じ使い方の単一パターン検索
+// 32バイトずつ, パターンの先頭と末尾の文字が一致する位置をAVX2の比較で絞り込み, 候補だけmemcmpで確かめる
+// 候補が多すぎる(照合したバイト数が走査したバイト数の数倍を超える)入力ではその位置からKMPに切り替える, 最悪O(|S|)
+// 末尾の32バイト未満もKMPで処理する
+template<typename T>
+struct simd_substring_search{
+  static_assert(sizeof(T) == 1);
+private:
+  kmp_algorithm<T> kmp;
+  int m;
+#ifdef SIMD_X86
+  // [from, ...)を走査してKMPで続きを始める位置を返す
+  __attribute__((target("avx2")))
+  int scan_avx2(const uint8_t *s, int n, int from, std::vector<int> &res)const{
+    const uint8_t *p = reinterpret_cast<const uint8_t*>(kmp.pattern().data());
+    const __m256i first = _mm256_set1_epi8(p[0]), last = _mm256_set1_epi8(p[m - 1]);
+    long long work = 0;
+    int i = from;
+    for(; (long long)i + m - 1 + 32 <= n; i += 32){
+      __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+      __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i + m - 1));
+      uint32_t mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last)));
+      while(mask){
+        int k = __builtin_ctz(mask);
+        if(m <= 2 || !memcmp(s + i + k + 1, p + 1, m - 2)) res.push_back(i + k);
+        work += m;
+        mask &= mask - 1;
+      }
+      if(work > 4LL * (i + 32 - from) + 4096) return i + 32;
+    }
+    return i;
+  }
+#endif
+public:
+  simd_substring_search(const std::vector<T> &pat): kmp(pat), m(pat.size()){}
+  // 一致する場所を返す
+  std::vector<int> find(const std::vector<T> &s)const{
+    return find(s.data(), s.size());
+  }
+  std::vector<int> find(const T *s, int n)const{
+    std::vector<int> res;
+    int i = 0;
+#ifdef SIMD_X86
+    if(cpu_feature::has_avx2()) i = scan_avx2(reinterpret_cast<const uint8_t*>(s), n, 0, res);
+#endif
+    kmp.find(s, n, i, res);
+    return res;
+  }
+};
+
+// 短いパターン(最大64個)の同時検索(Teddy)
+// パターンを先頭kバイト(k = min(3, 最短のパターン長))でソートして8個のバケットに分け,
+// 先頭からj文字目の上位/下位4bitごとに, その値を持つパターンがあるバケットのビットを立てた16バイトの表を作る
+// 32バイトずつ, 各jについてpshufbで表を引いてANDを取り, 0でないバイトの位置のバケットのパターンだけmemcmpで確かめる
+// 候補の多い入力(共通の接頭辞を持つパターンが多い等)では照合が O(|S| * パターン数 * 長さ) になりうる
+template<typename T>
+struct simd_teddy{
+  static_assert(sizeof(T) == 1);
+  static constexpr int MAX_PATTERNS = 64, BUCKETS = 8;
+private:
+  std::vector<std::vector<T>> pat;
+  int k;
+  std::array<std::array<uint8_t, 16>, 3> lo, hi;
+  std::array<std::vector<int>, BUCKETS> bucket;
+  // 位置qから始まるバケットbitsのパターンを確かめる
+  void verify(const uint8_t *s, int n, int q, uint8_t bits, std::vector<std::pair<int, int>> &res)const{
+    size_t sz = res.size();
+    while(bits){
+      int b = __builtin_ctz(bits);
+      bits &= bits - 1;
+      for(int id : bucket[b]){
+        int len = pat[id].size();
+        if(len <= n - q && !memcmp(s + q, pat[id].data(), len)) res.push_back({q, id});
+      }
+    }
+    if(res.size() - sz > 1) std::sort(res.begin() + sz, res.end());
+  }
+  // 開始位置[from, n - k]
+  void scan_scalar(const uint8_t *s, int n, int from, std::vector<std::pair<int, int>> &res)const{
+    for(int q = from; q + k <= n; q++){
+      uint8_t bits = 0xff;
+      for(int j = 0; j < k && bits; j++) bits &= lo[j][s[q + j] & 15] & hi[j][s[q + j] >> 4];
+      if(bits) verify(s, n, q, bits, res);
+    }
+  }
+#ifdef SIMD_X86
+  // 走査し終えていない最初の開始位置を返す
+  __attribute__((target("avx2")))
+  int scan_avx2(const uint8_t *s, int n, std::vector<std::pair<int, int>> &res)const{
+    __m256i L[3], H[3];
+    for(int j = 0; j < k; j++){
+      L[j] = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lo[j].data())));
+      H[j] = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hi[j].data())));
+    }
+    const __m256i low4 = _mm256_set1_epi8(15);
+    alignas(32) uint8_t buf[32];
+    int i = 0;
+    for(; (long long)i + k - 1 + 32 <= n; i += 32){
+      __m256i r = _mm256_set1_epi8(-1);
+      for(int j = 0; j < k; j++){
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i + j));
+        __m256i a = _mm256_shuffle_epi8(L[j], _mm256_and_si256(c, low4));
+        __m256i b = _mm256_shuffle_epi8(H[j], _mm256_and_si256(_mm256_srli_epi16(c, 4), low4));
+        r = _mm256_and_si256(r, _mm256_and_si256(a, b));
+      }
+      uint32_t mask = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(r, _mm256_setzero_si256()));
+      if(!mask) continue;
+      _mm256_store_si256(reinterpret_cast<__m256i*>(buf), r);
+      while(mask){
+        int q = __builtin_ctz(mask);
+        mask &= mask - 1;
+        verify(s, n, i + q, buf[q], res);
+      }
+    }
+    return i;
+  }
+#endif
+public:
+  // パターンは空でなく, 64個以下
+  simd_teddy(const std::vector<std::vector<T>> &_pat): pat(_pat){
+    int m = pat.size();
+    assert(0 < m && m <= MAX_PATTERNS);
+    k = 3;
+    for(auto &p : pat){
+      assert(!p.empty());
+      k = std::min(k, (int)p.size());
+    }
+    // 先頭kバイトが近いものを同じバケットに入れる
+    std::vector<int> ord(m);
+    std::iota(ord.begin(), ord.end(), 0);
+    std::sort(ord.begin(), ord.end(), [&](int a, int b){
+      return memcmp(pat[a].data(), pat[b].data(), k) < 0;
+    });
+    for(auto &t : lo) t.fill(0);
+    for(auto &t : hi) t.fill(0);
+    for(int i = 0; i < m; i++){
+      int id = ord[i], b = (long long)i * BUCKETS / m;
+      bucket[b].push_back(id);
+      for(int j = 0; j < k; j++){
+        uint8_t c = pat[id][j];
+        lo[j][c & 15] |= 1 << b;
+        hi[j][c >> 4] |= 1 << b;
+      }
+    }
+    for(auto &v : bucket) std::sort(v.begin(), v.end());
+  }
+  int size()const{
+    return pat.size();
+  }
+  // {開始位置, パターン番号}を(開始位置, パターン番号)の昇順で返す
+  std::vector<std::pair<int, int>> find(const std::vector<T> &s)const{
+    return find(s.data(), s.size());
+  }
+  std::vector<std::pair<int, int>> find(const T *_s, int n)const{
+    const uint8_t *s = reinterpret_cast<const uint8_t*>(_s);
+    std::vector<std::pair<int, int>> res;
+    int i = 0;
+#ifdef SIMD_X86
+    if(cpu_feature::has_avx2()) i = scan_avx2(s, n, res);
+#endif
+    scan_scalar(s, n, i, res);
+    return res;
+  }
+};
+#endif